@@ -1,4 +1,11 @@
-#define _POSIX_C_SOURCE 200809L
+// osh — a small Unix shell with history and in-process built-ins
+//       (cd, pwd, echo, true, false, export, unset, type) and $(...) / `...`
+//       command substitution.
+// Build:   gcc -Wall -Wextra -std=c11 -O2 -pthread -I../common -o shell shell.c ../common/perfctr.c
+// Run:     ./shell          # interactive
+//          ./shell -P       # also report the cost of every command (children included) on exit
+
+#define _GNU_SOURCE            // pipe2, F_SETPIPE_SZ
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -7,10 +14,14 @@
 #include <sys/wait.h>
 #include <ctype.h>
 #include <errno.h>
+#include <fcntl.h>
+
+#include "perfctr.h"
 
 #define MAX_LINE     1024      // maximum length of command line
-#define MAX_ARGS     64        // maximum number of arguments
 #define HISTORY_SIZE 5         // keep last 5 commands
+#define CAPTURE_READ (64 * 1024)    // bytes per read() when capturing $(...) output
+#define CAPTURE_PIPE (1024 * 1024)  // pipe size asked for with F_SETPIPE_SZ
 
 // --------- History (circular buffer) ----------
 typedef struct {
@@ -142,22 +153,34 @@ void strip_background_amp(char *line, int *is_bg) {
     }
 }
 
-// Tokenize line into argv[], returns argc. Modifies line in-place (inserts NULs).
-int parse_args(char *line, char *argv[MAX_ARGS]) {
-    int argc = 0;
+// Tokenize line into a NULL-terminated argv, stores the word count in *argc.
+// Modifies line in-place (inserts NULs). argv is sized from the line, so a
+// long $(...) expansion is never cut short; the caller frees it.
+char** parse_args(char *line, int *argc) {
+    // Each word takes at least one character plus a separator.
+    size_t cap = strlen(line) / 2 + 2;
+    char **argv = malloc(cap * sizeof(*argv));
+
+    if (!argv) {
+        perror("malloc");
+        exit(EXIT_FAILURE);
+    }
+
+    int n = 0;
     char *tok = strtok(line, " \t");
-    
-    while (tok && argc < MAX_ARGS - 1) {
-        argv[argc++] = tok;
+
+    while (tok) {
+        argv[n++] = tok;
         tok = strtok(NULL, " \t");
     }
 
-    argv[argc] = NULL;
-    return argc;
+    argv[n] = NULL;
+    *argc = n;
+    return argv;
 }
 
 // Join argv back to a single space-separated string (for echo/history), up to out_cap.
-void join_args(char *out, size_t out_cap, char *const argv[MAX_ARGS]) {
+void join_args(char *out, size_t out_cap, char *const argv[]) {
     out[0] = '\0';
     size_t used = 0;
 
@@ -178,8 +201,283 @@ void join_args(char *out, size_t out_cap, char *const argv[MAX_ARGS]) {
     }
 }
 
+// --------- Built-ins ----------
+// Commands that run inside the shell process itself, with no fork or exec.
+// `cd` and `export`/`unset` only work this way, because a child cannot change the
+// shell's directory or environment. The others are cheap enough that fork+exec
+// would be nearly all of their cost. To add one, write a handler and add a row to
+// `builtins` below. Rows without a handler (history, exit) are handled directly in
+// main, because they must not be stored in history; they are listed here so that
+// `type` knows about them.
+// Built-ins always run in the foreground; a trailing '&' is ignored.
+
+extern char **environ;
+
+typedef int (*builtin_fn)(int argc, char *const argv[]);
+
+typedef struct {
+    const char *name;
+    builtin_fn fn;     // returns the exit status
+} Builtin;
+
+int builtin_cd(int argc, char *const argv[]) {
+    const char *dir = argc > 1 ? argv[1] : getenv("HOME");
+    int print_dir = 0;
+
+    if (dir && strcmp(dir, "-") == 0) {
+        dir = getenv("OLDPWD");
+        print_dir = 1;
+    }
+
+    if (!dir) {
+        fprintf(stderr, "cd: %s not set\n", argc > 1 ? "OLDPWD" : "HOME");
+        return 1;
+    }
+
+    char old[4096];
+    int have_old = getcwd(old, sizeof(old)) != NULL;
+
+    if (chdir(dir) != 0) {
+        fprintf(stderr, "cd: %s: %s\n", dir, strerror(errno));
+        return 1;
+    }
+
+    char cwd[4096];
+    if (have_old) {
+        setenv("OLDPWD", old, 1);
+    }
+
+    if (getcwd(cwd, sizeof(cwd))) {
+        setenv("PWD", cwd, 1);
+        if (print_dir) {
+            printf("%s\n", cwd);
+        }
+    }
+
+    return 0;
+}
+
+int builtin_pwd(int argc, char *const argv[]) {
+    (void)argc;
+    (void)argv;
+    char cwd[4096];
+
+    if (!getcwd(cwd, sizeof(cwd))) {
+        perror("pwd");
+        return 1;
+    }
+
+    printf("%s\n", cwd);
+    return 0;
+}
+
+// echo [-n] args...
+int builtin_echo(int argc, char *const argv[]) {
+    int i = 1;
+    int newline = 1;
+
+    if (argc > 1 && strcmp(argv[1], "-n") == 0) {
+        newline = 0;
+        i = 2;
+    }
+
+    for (int first = i; i < argc; ++i) {
+        if (i > first) {
+            putchar(' ');
+        }
+        fputs(argv[i], stdout);
+    }
+
+    if (newline) {
+        putchar('\n');
+    }
+
+    return 0;
+}
+
+int builtin_true(int argc, char *const argv[]) {
+    (void)argc;
+    (void)argv;
+    return 0;
+}
+
+int builtin_false(int argc, char *const argv[]) {
+    (void)argc;
+    (void)argv;
+    return 1;
+}
+
+// export NAME=VALUE | export NAME | export (list)
+int builtin_export(int argc, char *const argv[]) {
+    if (argc == 1) {
+        for (char **e = environ; *e; ++e) {
+            printf("export %s\n", *e);
+        }
+        return 0;
+    }
+
+    int status = 0;
+
+    for (int i = 1; i < argc; ++i) {
+        char name[MAX_LINE];
+        const char *eq = strchr(argv[i], '=');
+        size_t len = eq ? (size_t)(eq - argv[i]) : strlen(argv[i]);
+
+        if (len == 0 || len >= sizeof(name)) {
+            fprintf(stderr, "export: `%s': not a valid identifier\n", argv[i]);
+            status = 1;
+            continue;
+        }
+
+        memcpy(name, argv[i], len);
+        name[len] = '\0';
+
+        // osh has no unexported variables, so "export NAME" only has to
+        // create NAME (empty) when it does not exist yet.
+        if (!eq && getenv(name)) {
+            continue;
+        }
+
+        if (setenv(name, eq ? eq + 1 : "", 1) != 0) {
+            fprintf(stderr, "export: %s: %s\n", argv[i], strerror(errno));
+            status = 1;
+        }
+    }
+
+    return status;
+}
+
+int builtin_unset(int argc, char *const argv[]) {
+    int status = 0;
+
+    for (int i = 1; i < argc; ++i) {
+        if (unsetenv(argv[i]) != 0) {
+            fprintf(stderr, "unset: %s: %s\n", argv[i], strerror(errno));
+            status = 1;
+        }
+    }
+
+    return status;
+}
+
+int builtin_type(int argc, char *const argv[]);
+
+static const Builtin builtins[] = {
+    { "cd",      builtin_cd },
+    { "pwd",     builtin_pwd },
+    { "echo",    builtin_echo },
+    { "true",    builtin_true },
+    { "false",   builtin_false },
+    { "export",  builtin_export },
+    { "unset",   builtin_unset },
+    { "type",    builtin_type },
+    { "history", NULL },
+    { "exit",    NULL },
+};
+
+const Builtin* find_builtin(const char *name) {
+    for (size_t i = 0; i < sizeof(builtins) / sizeof(builtins[0]); ++i) {
+        if (strcmp(builtins[i].name, name) == 0) {
+            return &builtins[i];
+        }
+    }
+
+    return NULL;
+}
+
+// Search $PATH the way execvp does. Writes the match into out; returns 1 if found.
+int search_path(const char *name, char *out, size_t out_cap) {
+    if (strchr(name, '/')) {
+        snprintf(out, out_cap, "%s", name);
+        return access(out, X_OK) == 0;
+    }
+
+    const char *path = getenv("PATH");
+    if (!path) {
+        path = "/usr/local/bin:/usr/bin:/bin";
+    }
+
+    while (*path) {
+        const char *colon = strchr(path, ':');
+        size_t len = colon ? (size_t)(colon - path) : strlen(path);
+
+        // An empty entry means the current directory.
+        int n = len ? snprintf(out, out_cap, "%.*s/%s", (int)len, path, name)
+                    : snprintf(out, out_cap, "%s", name);
+
+        if (n > 0 && (size_t)n < out_cap && access(out, X_OK) == 0) {
+            return 1;
+        }
+
+        if (!colon) {
+            break;
+        }
+        path = colon + 1;
+    }
+
+    return 0;
+}
+
+int builtin_type(int argc, char *const argv[]) {
+    int status = 0;
+
+    for (int i = 1; i < argc; ++i) {
+        char path[4096];
+
+        if (find_builtin(argv[i])) {
+            printf("%s is a shell builtin\n", argv[i]);
+        } else if (search_path(argv[i], path, sizeof(path))) {
+            printf("%s is %s\n", argv[i], path);
+        } else {
+            fprintf(stderr, "type: %s: not found\n", argv[i]);
+            status = 1;
+        }
+    }
+
+    return status;
+}
+
+// Run argv in-process if it names a built-in with a handler.
+// Returns 1 (and the exit status in *status) if it did, 0 otherwise.
+int run_builtin(char *const argv[], int *status) {
+    const Builtin *b = find_builtin(argv[0]);
+
+    if (!b || !b->fn) {
+        return 0;
+    }
+
+    int argc = 0;
+    while (argv[argc]) {
+        argc++;
+    }
+
+    *status = b->fn(argc, argv);
+    // Keep our output ordered with whatever the next child writes to the same fd.
+    fflush(stdout);
+    return 1;
+}
+
+// In a freshly forked child: run argv as a built-in or exec it. Never returns.
+void exec_in_child(char *const argv[]) {
+    int status;
+    if (run_builtin(argv, &status)) {
+        _exit(status);
+    }
+
+    execvp(argv[0], argv);
+    // If execvp returns, it's an error
+    perror("execvp");
+    _exit(127);
+}
+
 // Execute one parsed command (argv). If bg==0, waits; else returns immediately in parent.
-void execute_command(char *const argv[MAX_ARGS], int bg) {
+// Built-ins run in the shell process and never fork.
+void execute_command(char *const argv[], int bg) {
+    int status;
+    if (run_builtin(argv, &status)) {
+        return;
+    }
+
     pid_t pid = fork();
 
     if (pid < 0) {
@@ -189,14 +487,11 @@ void execute_command(char *const argv[MAX_ARGS], int bg) {
 
     if (pid == 0) {
         // Child: replace image
-        execvp(argv[0], argv);
-        // If execvp returns, it's an error
-        perror("execvp");
-        _exit(127);
+        exec_in_child(argv);
     } else {
         // Parent
         if (!bg) {
-            int status = 0;
+            status = 0;
             if (waitpid(pid, &status, 0) < 0) {
                 perror("waitpid");
             }
@@ -207,7 +502,219 @@ void execute_command(char *const argv[MAX_ARGS], int bg) {
     }
 }
 
-int main(void) {
+// --------- Command substitution: $(...) and `...` ----------
+// The inner command runs in a forked child, built-ins included, so `$(cd x)`
+// cannot change the shell's directory, like a subshell. Its stdout goes into
+// a pipe, and the shell reads it into memory in large chunks. Trailing
+// newlines are dropped and the other newlines become spaces, so the output
+// splits into words like the rest of the line. $(...) may nest; backticks may
+// not, but they may sit inside a $(...).
+
+// Growable byte buffer, always NUL-terminated once anything is appended.
+typedef struct {
+    char *data;
+    size_t len;
+    size_t cap;
+} StrBuf;
+
+void sb_reserve(StrBuf *b, size_t extra) {
+    if (b->len + extra + 1 <= b->cap) {
+        return;
+    }
+
+    size_t cap = b->cap ? b->cap : 256;
+    while (cap < b->len + extra + 1) {
+        cap *= 2;
+    }
+
+    char *p = realloc(b->data, cap);
+    if (!p) {
+        perror("realloc");
+        exit(EXIT_FAILURE);
+    }
+
+    b->data = p;
+    b->cap = cap;
+}
+
+void sb_append(StrBuf *b, const char *s, size_t n) {
+    sb_reserve(b, n);
+    memcpy(b->data + b->len, s, n);
+    b->len += n;
+    b->data[b->len] = '\0';
+}
+
+char* expand_substitutions(const char *line);
+
+// Run cmd (after expanding any substitutions inside it) with its stdout
+// captured. Appends the output to out. Returns 0, or -1 if it could not run.
+int capture_output(const char *cmd, StrBuf *out) {
+    char *expanded = expand_substitutions(cmd);
+    if (!expanded) {
+        return -1;
+    }
+
+    int argc;
+    char **argv = parse_args(expanded, &argc);
+    if (argc == 0) {
+        free(argv);
+        free(expanded);
+        return 0;               // $() is empty
+    }
+
+    // O_CLOEXEC keeps these ends out of every other child this shell starts, so
+    // none of them can hold the write end open and delay EOF.
+    int fds[2];
+    if (pipe2(fds, O_CLOEXEC) != 0) {
+        perror("pipe2");
+        free(argv);
+        free(expanded);
+        return -1;
+    }
+
+    // A bigger pipe means fewer trips through the scheduler for large output.
+    // Failure (e.g. above /proc/sys/fs/pipe-max-size) just keeps the default.
+    fcntl(fds[1], F_SETPIPE_SZ, CAPTURE_PIPE);
+
+    fflush(stdout);             // do not duplicate our buffered output in the child
+    pid_t pid = fork();
+
+    if (pid < 0) {
+        perror("fork");
+        close(fds[0]);
+        close(fds[1]);
+        free(argv);
+        free(expanded);
+        return -1;
+    }
+
+    if (pid == 0) {
+        // dup2 clears close-on-exec on fd 1; the originals must be closed
+        // explicitly, since a built-in never reaches exec.
+        dup2(fds[1], STDOUT_FILENO);
+        close(fds[0]);
+        close(fds[1]);
+        exec_in_child(argv);
+    }
+
+    close(fds[1]);
+
+    for (;;) {
+        sb_reserve(out, CAPTURE_READ);
+        ssize_t n = read(fds[0], out->data + out->len, out->cap - out->len - 1);
+
+        if (n > 0) {
+            out->len += (size_t)n;
+        } else if (n == 0 || errno != EINTR) {
+            if (n < 0) {
+                perror("read");
+            }
+            break;
+        }
+    }
+
+    out->data[out->len] = '\0';
+    close(fds[0]);
+
+    int status;
+    while (waitpid(pid, &status, 0) < 0 && errno == EINTR) {
+    }
+
+    free(argv);
+    free(expanded);
+    return 0;
+}
+
+// Return a malloc'd copy of line with every $(...) and `...` replaced by the
+// output of its command, or NULL (after a message) if one is unterminated or
+// cannot run.
+char* expand_substitutions(const char *line) {
+    StrBuf out = { 0 };
+    sb_append(&out, "", 0);
+
+    for (const char *p = line; *p; ) {
+        const char *body = NULL;
+        const char *end = NULL;
+
+        if (p[0] == '$' && p[1] == '(') {
+            body = p + 2;
+            int depth = 1;
+
+            for (end = body; *end; ++end) {
+                if (*end == '(') {
+                    depth++;
+                } else if (*end == ')' && --depth == 0) {
+                    break;
+                }
+            }
+
+            if (!*end) {
+                fprintf(stderr, "osh: unterminated $(\n");
+                free(out.data);
+                return NULL;
+            }
+        } else if (p[0] == '`') {
+            body = p + 1;
+            end = strchr(body, '`');
+
+            if (!end) {
+                fprintf(stderr, "osh: unterminated `\n");
+                free(out.data);
+                return NULL;
+            }
+        } else {
+            // Copy the plain run up to the next possible substitution in one go.
+            size_t n = strcspn(p + 1, "$`") + 1;
+            sb_append(&out, p, n);
+            p += n;
+            continue;
+        }
+
+        char *cmd = strndup(body, (size_t)(end - body));
+        if (!cmd) {
+            perror("strndup");
+            exit(EXIT_FAILURE);
+        }
+
+        size_t start = out.len;
+        int rc = capture_output(cmd, &out);
+        free(cmd);
+
+        if (rc != 0) {
+            free(out.data);
+            return NULL;
+        }
+
+        while (out.len > start && out.data[out.len - 1] == '\n') {
+            out.len--;
+        }
+        out.data[out.len] = '\0';
+
+        for (size_t i = start; i < out.len; ++i) {
+            if (out.data[i] == '\n') {
+                out.data[i] = ' ';
+            }
+        }
+
+        p = end + 1;
+    }
+
+    return out.data;
+}
+
+int main(int argc, char **argv) {
+    int opt;
+    while ((opt = getopt(argc, argv, "Ph")) != -1) {
+        switch (opt) {
+            // Inherited counters, so each command's child process is counted once reaped.
+            case 'P': perfctr_init(PERFCTR_INHERIT); break;
+            default:
+                fprintf(stderr, "Usage: %s [-P]\n", argv[0]);
+                return opt == 'h' ? 0 : EXIT_FAILURE;
+        }
+    }
+    int r_command = perfctr_region("command");
+
     History hist;
     history_init(&hist);
 
@@ -261,48 +768,53 @@ int main(void) {
             // Echo the command to the user (as specified)
             printf("%s\n", recent);
 
-            // Parse and execute the recent command
-            char tmp[MAX_LINE];
-            strncpy(tmp, recent, sizeof(tmp));
-            tmp[sizeof(tmp)-1] = '\0';
-
-            // Prepare argv
-            char *argv[MAX_ARGS];
-            int argc = parse_args(tmp, argv);
-            if (argc == 0) {
-                continue;
-            }
-
-            // Add to history as the "next" command
+            // Add to history as the "next" command (unexpanded, like any other)
             history_add(&hist, recent);
+            recent = history_most_recent(&hist);
+
+            // Expand, parse and execute the recent command
+            // (foreground by default for repeated commands)
+            perfctr_start(r_command);
+            char *expanded = expand_substitutions(recent);
+
+            if (expanded) {
+                int argc;
+                char **argv = parse_args(expanded, &argc);
+                if (argc > 0) {
+                    execute_command(argv, 0);
+                }
+                free(argv);
+            }
 
-            // Execute (foreground by default for repeated commands)
-            execute_command(argv, 0);
+            free(expanded);
+            perfctr_stop(r_command);
             continue;
         }
 
-        // For a "normal" command: parse args
-        // Make a safe copy for history before parse (without '&')
-        char line_copy_for_history[MAX_LINE];
-        strncpy(line_copy_for_history, line, sizeof(line_copy_for_history));
-        line_copy_for_history[sizeof(line_copy_for_history)-1] = '\0';
-
-        // Build argv from the working buffer (in-place tokenization)
-        char work[MAX_LINE];
-        strncpy(work, line, sizeof(work));
-        work[sizeof(work)-1] = '\0';
-
-        char *argv[MAX_ARGS];
-        int argc = parse_args(work, argv);
-        if (argc == 0) continue; // should not happen after trimming
-
-        // Add to history (exclude 'history'/'exit' handled above, and we already stripped '&')
-        history_add(&hist, str_trim(line_copy_for_history));
+        // For a "normal" command: add to history as typed, before any
+        // substitution (exclude 'history'/'exit' handled above, and we already stripped '&')
+        history_add(&hist, str_trim(line));
+
+        // Substitute $(...) and `...`, then build argv from the expanded copy
+        // (in-place tokenization)
+        perfctr_start(r_command);
+        char *expanded = expand_substitutions(line);
+
+        // Execute (the expansion may be empty, e.g. a lone $(true))
+        if (expanded) {
+            int argc;
+            char **argv = parse_args(expanded, &argc);
+            if (argc > 0) {
+                execute_command(argv, is_bg);
+            }
+            free(argv);
+        }
 
-        // Execute
-        execute_command(argv, is_bg);
+        free(expanded);
+        perfctr_stop(r_command);
     }
 
     history_free(&hist);
+    perfctr_report(stderr);
     return 0;
 }
\ No newline at end of file
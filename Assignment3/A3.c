@@ -1,17 +1,31 @@
-/*  A3.c  — Sleeping Teaching Assistant (POSIX threads + semaphores)
+/*  A3.c  — Sleeping Teaching Assistant (POSIX threads or processes + semaphores)
  *
  *  Compile:
- *      gcc -std=c11 -O2 -pthread A3.c -o A3
+ *      gcc -std=c11 -O2 -pthread -I../common A3.c ../common/perfctr.c -o A3
  *
  *  Run (examples):
  *      ./A3                    # defaults: 5 students, 3 chairs, 3 help-requests per student
  *      ./A3 -s 8              # 8 students
  *      ./A3 -s 6 -c 3 -r 4    # 6 students, 3 chairs, each student seeks help 4 times
+ *      ./A3 -P                # also report per-region counters at the end
+ *      ./A3 -s 20 -c 8 -b 4 -q -x 0.01   # batched help sessions, quiet, 100x faster
+ *      ./A3 -s 20 -c 8 -q -x 0 -p         # TA and students as processes; compare without -p
+ *      ./A3 -s 50 -r 100 -q -m & ./a3top $!   # watch a long run live
  *
  *  Flags:
  *      -s <int>   number of student threads          (default 5)
  *      -c <int>   number of hallway chairs           (default 3)
  *      -r <int>   help requests per student          (default 3)
+ *      -P         count CPU time, context switches, cycles, ... per thread in the TA nap,
+ *                 TA help and student seek-help regions; summed report on stderr
+ *      -b <int>   batch size: the TA admits up to this many waiting students at once
+ *                 and helps them as one group (default 1: one student per session)
+ *      -q         quiet: no per-event lines, only the config and the summary
+ *      -x <float> time scale for programming/help times (default 1.0; 0.01 = 100x faster)
+ *      -p         run the TA and every student as separate processes instead of threads
+ *                 (with -P only one combined "processes" region is reported)
+ *      -m         publish live counters in the shared memory object /a3-metrics-<pid>;
+ *                 watch them with ./a3top <pid> (see a3top.c)
  *
  *  Notes:
  *    - This is the classic “sleeping barber” pattern adapted to the TA setting.
@@ -23,6 +37,23 @@
  *    - The TA “naps” by blocking on sem_wait(customers). Students “wake” the TA with sem_post(customers).
  *    - Students either take a chair (if available), or leave to program more and try later.
  *    - To exit gracefully, the TA uses sem_timedwait to periodically check if all students are done.
+ *    - Batched mode (-b K > 1): after waking, the TA takes up to K students off the chairs,
+ *      advances the `admitted` ticket counter by that many and wakes them all with one
+ *      pthread_cond_broadcast(admitted_cv). Each student waits until its ticket is admitted,
+ *      so students are still admitted in arrival order. One wakeup of the TA and one help
+ *      session then serve the whole group instead of one student each.
+ *    - At the end a summary reports requests served, sessions, TA wakeups and context
+ *      switches per request, throughput, and the mean time a seated student waits for the TA.
+ *    - Process mode (-p): all shared state (semaphores, mutex, condvar, counters) sits in one
+ *      SharedState struct. It is placed in a shm_open() segment before forking, with
+ *      pshared semaphores and a PTHREAD_PROCESS_SHARED robust mutex and condvar; a
+ *      process that dies holding the lock leaves it EOWNERDEAD and the next locker
+ *      recovers it. Threads use the same struct on the heap, so both modes run the same
+ *      TA and student code and the summaries can be compared directly.
+ *    - Live metrics (-m): every TA/student updates only its own cache-line-sized slot in a
+ *      shm_open() segment, under a per-slot sequence count; `waiting` is published under
+ *      mtx. A reader (a3top) can sample as often as it likes without taking any lock
+ *      or writing to the segment. Layout in a3_metrics.h.
  */
 
 #define _XOPEN_SOURCE 700
@@ -33,9 +64,19 @@
 #include <time.h>
 #include <errno.h>
 #include <stdatomic.h>
+#include <stdint.h>
 #include <pthread.h>
 #include <semaphore.h>
+#include <signal.h>
 #include <string.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+
+#include "perfctr.h"
+#include "a3_metrics.h"
 
 typedef struct {
     int id;
@@ -47,13 +88,25 @@ typedef struct {
 static int NUM_STUDENTS = 5;
 static int NUM_CHAIRS  = 3;
 static int REQS_PER_STUDENT = 3;
+static bool PERF = false;
+static int BATCH_SIZE = 1;
+static bool QUIET = false;
+static double TIME_SCALE = 1.0;
+static bool METRICS = false;
+
+/* per-event log lines, silenced by -q */
+#define LOG(...) do { if (!QUIET) printf(__VA_ARGS__); } while (0)
 
-/* milliseconds helpers */
+/* perfctr regions (-1 = not counting) */
+static int R_TA_NAP = -1, R_TA_HELP = -1, R_STU_SEEK = -1;
+
+/* milliseconds helpers (simulated work; stretched or shrunk by -x) */
 static void sleep_ms(int ms) {
-    if (ms <= 0) return;
+    long long ns = (long long)((double)ms * TIME_SCALE * 1e6);
+    if (ns <= 0) return;
     struct timespec ts;
-    ts.tv_sec  = ms / 1000;
-    ts.tv_nsec = (long)(ms % 1000) * 1000000L;
+    ts.tv_sec  = (time_t)(ns / 1000000000LL);
+    ts.tv_nsec = (long)(ns % 1000000000LL);
     nanosleep(&ts, NULL);
 }
 
@@ -86,13 +139,205 @@ static bool sem_wait_ms(sem_t *sem, int timeout_ms) {
     }
 }
 
-/* ---------- Shared state ---------- */
-static sem_t customers;     /* counts waiting students; TA sleeps on this when 0 */
-static sem_t ta_ready;      /* TA signals a seat/session is ready for exactly one student */
-static pthread_mutex_t mtx = PTHREAD_MUTEX_INITIALIZER;
+/* ---------- Shared state ----------
+ * Everything the TA and the students share lives in one struct. With threads it is
+ * ordinary heap memory; with -p it is a shm_open() segment that every forked process
+ * has mapped, and the semaphores, mutex and condvar are initialized process-shared.
+ */
+typedef struct {
+    sem_t customers;            /* counts waiting students; TA sleeps on this when 0 */
+    sem_t ta_ready;             /* TA signals a seat/session is ready for exactly one student */
+    pthread_mutex_t mtx;        /* protects the fields below up to `admitted`; robust with -p */
+
+    int waiting;                /* # of students currently sitting in chairs */
+
+    /* Batched mode only (under mtx): tickets handed to seated students, and how many have been admitted. */
+    pthread_cond_t admitted_cv;
+    long long next_ticket;
+    long long admitted;
+
+    atomic_int students_active; /* # of students still running */
+
+    /* Summary counters */
+    atomic_int served;          /* requests that got help */
+    atomic_int turned_away;     /* found no free chair */
+    atomic_int sessions;        /* help sessions (= TA wakeups that found work) */
+    atomic_llong wait_ns;       /* total time from taking a chair to being admitted */
+} SharedState;
+
+static SharedState *S;
+static bool PROCESS_MODE = false;
+
+static long long now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+/* Allocate and initialize S; pshared selects the shm_open segment and process-shared objects. */
+static int shared_init(bool pshared) {
+    if (pshared) {
+        char name[64];
+        snprintf(name, sizeof(name), "/a3-%d", (int)getpid());
+        int fd = shm_open(name, O_CREAT | O_EXCL | O_RDWR, 0600);
+        if (fd < 0) { perror("shm_open"); return -1; }
+        /* The children inherit the mapping across fork(), so the name is not needed past this point. */
+        shm_unlink(name);
+        if (ftruncate(fd, sizeof(SharedState)) != 0) { perror("ftruncate"); close(fd); return -1; }
+        S = mmap(NULL, sizeof(SharedState), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        close(fd);
+        if (S == MAP_FAILED) { perror("mmap"); S = NULL; return -1; }
+    } else {
+        S = calloc(1, sizeof(SharedState));
+        if (!S) { perror("calloc"); return -1; }
+    }
+
+    int ps = pshared ? PTHREAD_PROCESS_SHARED : PTHREAD_PROCESS_PRIVATE;
+    if (sem_init(&S->customers, pshared, 0) != 0) { perror("sem_init(customers)"); return -1; }
+    if (sem_init(&S->ta_ready,  pshared, 0) != 0) { perror("sem_init(ta_ready)");  return -1; }
+
+    pthread_mutexattr_t ma;
+    pthread_mutexattr_init(&ma);
+    pthread_mutexattr_setpshared(&ma, ps);
+    /* A process killed while holding the lock must not wedge everyone else. */
+    if (pshared) pthread_mutexattr_setrobust(&ma, PTHREAD_MUTEX_ROBUST);
+    int rc = pthread_mutex_init(&S->mtx, &ma);
+    pthread_mutexattr_destroy(&ma);
+    if (rc != 0) { errno = rc; perror("pthread_mutex_init"); return -1; }
+
+    pthread_condattr_t ca;
+    pthread_condattr_init(&ca);
+    pthread_condattr_setpshared(&ca, ps);
+    rc = pthread_cond_init(&S->admitted_cv, &ca);
+    pthread_condattr_destroy(&ca);
+    if (rc != 0) { errno = rc; perror("pthread_cond_init"); return -1; }
+
+    S->waiting = 0;
+    S->next_ticket = S->admitted = 0;
+    atomic_init(&S->students_active, 0);
+    atomic_init(&S->served, 0);
+    atomic_init(&S->turned_away, 0);
+    atomic_init(&S->sessions, 0);
+    atomic_init(&S->wait_ns, 0);
+    return 0;
+}
+
+static void shared_destroy(void) {
+    sem_destroy(&S->customers);
+    sem_destroy(&S->ta_ready);
+    pthread_mutex_destroy(&S->mtx);
+    pthread_cond_destroy(&S->admitted_cv);
+    if (PROCESS_MODE) munmap(S, sizeof(SharedState));
+    else free(S);
+    S = NULL;
+}
+
+/* The previous owner died holding the robust mutex: the counts it guards are still
+ * self-consistent at every unlock point, so just mark the mutex usable again. */
+static void recover_owner_dead(int rc) {
+    if (rc == EOWNERDEAD) {
+        fprintf(stderr, "[warn] a process died holding the lock; recovering\n");
+        pthread_mutex_consistent(&S->mtx);
+    }
+}
+
+static void lock_state(void) {
+    recover_owner_dead(pthread_mutex_lock(&S->mtx));
+}
+
+static void unlock_state(void) {
+    pthread_mutex_unlock(&S->mtx);
+}
+
+/* ---------- Live metrics (-m) ---------- */
+static a3_metrics *M;           /* NULL unless -m */
+static char METRICS_NAME[64];
+static pid_t METRICS_OWNER;     /* the process that must unlink the name (0 once done) */
+
+/* Update a metrics slot (NULL when -m is off) as one seqlock write section. */
+#define METRICS_UPDATE(slot, ...) \
+    do { if (slot) { a3_seq_begin(&(slot)->seq); __VA_ARGS__; a3_seq_end(&(slot)->seq); } } while (0)
+
+/* Remove the name if this is still the owning process. Forked TA/student processes
+ * inherit the handlers below but leave the name to the parent. */
+static void metrics_unlink(void) {
+    if (METRICS_OWNER != 0 && getpid() == METRICS_OWNER) {
+        shm_unlink(METRICS_NAME);
+        METRICS_OWNER = 0;
+    }
+}
+
+/* An aborted run (Ctrl-C, kill) must not leave /dev/shm/a3-metrics-<pid> behind. */
+static void metrics_on_signal(int sig) {
+    metrics_unlink();
+    signal(sig, SIG_DFL);
+    raise(sig);
+}
+
+/* Create the segment before any TA/student starts, so forked processes inherit the mapping. */
+static int metrics_init(void) {
+    int nslots = NUM_STUDENTS + 1;
+    size_t size = a3_metrics_size(nslots);
+    snprintf(METRICS_NAME, sizeof(METRICS_NAME), A3_METRICS_NAME_FMT, (int)getpid());
+    int fd = shm_open(METRICS_NAME, O_CREAT | O_EXCL | O_RDWR, 0644);
+    if (fd < 0) { perror("shm_open(metrics)"); return -1; }
+    if (ftruncate(fd, (off_t)size) != 0) {
+        perror("ftruncate(metrics)");
+        close(fd);
+        shm_unlink(METRICS_NAME);
+        return -1;
+    }
+    M = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (M == MAP_FAILED) { perror("mmap(metrics)"); M = NULL; shm_unlink(METRICS_NAME); return -1; }
+
+    /* From here on the name is removed on every way out: normal return, exit(), or a signal. */
+    METRICS_OWNER = getpid();
+    atexit(metrics_unlink);
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = metrics_on_signal;
+    sigemptyset(&sa.sa_mask);
+    sigaction(SIGINT, &sa, NULL);
+    sigaction(SIGTERM, &sa, NULL);
+    sigaction(SIGHUP, &sa, NULL);
+
+    M->version  = A3_METRICS_VERSION;
+    M->pid      = (int)getpid();
+    M->nslots   = nslots;
+    M->chairs   = NUM_CHAIRS;
+    M->batch    = BATCH_SIZE;
+    M->start_ns = now_ns();
+    M->slots[0].state = A3_TA_NAPPING;
+    for (int i = 1; i < nslots; ++i) M->slots[i].state = A3_STU_PROGRAMMING;
+    /* Readers treat the segment as valid once they see the magic. */
+    atomic_thread_fence(memory_order_release);
+    M->magic = A3_METRICS_MAGIC;
+
+    fprintf(stderr, "metrics: %s (watch with ./a3top %d)\n", METRICS_NAME, M->pid);
+    return 0;
+}
 
-static int waiting = 0;                 /* # of students currently sitting in chairs */
-static atomic_int students_active = 0;  /* # of student threads still running */
+/* Caller holds mtx. */
+static void metrics_waiting(void) {
+    if (!M) return;
+    a3_seq_begin(&M->live.seq);
+    M->live.waiting = S->waiting;
+    a3_seq_end(&M->live.seq);
+}
+
+/* Mark the run finished for readers still attached, then remove the name. */
+static void metrics_finish(void) {
+    if (!M) return;
+    lock_state();
+    a3_seq_begin(&M->live.seq);
+    M->live.finished = 1;
+    a3_seq_end(&M->live.seq);
+    unlock_state();
+    munmap(M, a3_metrics_size(M->nslots));
+    M = NULL;
+    metrics_unlink();
+}
 
 /* ---------- Parameters for simulated work ---------- */
 enum {
@@ -104,17 +349,22 @@ enum {
 /* ---------- TA thread ---------- */
 static void *ta_thread(void *arg) {
     (void)arg;
-    printf("[TA  ] Office open. Napping until a student arrives...\n");
+    a3_slot *me = M ? &M->slots[0] : NULL;
+    LOG("[TA  ] Office open. Napping until a student arrives...\n");
 
     while (1) {
         /* Nap until a waiting student appears, but wake periodically to check for shutdown. */
-        if (!sem_wait_ms(&customers, TA_POLL_MS)) {
+        perfctr_start(R_TA_NAP);
+        bool got = sem_wait_ms(&S->customers, TA_POLL_MS);
+        perfctr_stop(R_TA_NAP);
+        if (!got) {
             /* timed out; check for graceful shutdown */
-            pthread_mutex_lock(&mtx);
-            int w = waiting;
-            pthread_mutex_unlock(&mtx);
-            if (atomic_load(&students_active) == 0 && w == 0) {
-                printf("[TA  ] No more students and no one waiting. Closing office.\n");
+            lock_state();
+            int w = S->waiting;
+            unlock_state();
+            if (atomic_load(&S->students_active) == 0 && w == 0) {
+                LOG("[TA  ] No more students and no one waiting. Closing office.\n");
+                METRICS_UPDATE(me, me->state = A3_TA_CLOSED);
                 break;
             }
             /* otherwise, keep napping */
@@ -122,17 +372,45 @@ static void *ta_thread(void *arg) {
         }
 
         /* A student is waiting (or just arrived). Sit them with the TA. */
-        pthread_mutex_lock(&mtx);
-        if (waiting > 0) waiting--;  /* one student leaves the chair to get help */
-        pthread_mutex_unlock(&mtx);
+        perfctr_start(R_TA_HELP);
+        long long help_start = now_ns();
+        METRICS_UPDATE(me, me->state = A3_TA_HELPING);
+        int group = 1;
+        if (BATCH_SIZE > 1) {
+            /* Admit up to BATCH_SIZE students with one broadcast. */
+            lock_state();
+            group = S->waiting < BATCH_SIZE ? S->waiting : BATCH_SIZE;
+            S->waiting  -= group;
+            S->admitted += group;
+            metrics_waiting();
+            pthread_cond_broadcast(&S->admitted_cv);
+            unlock_state();
+
+            /* Every seated student posted `customers` once; this wake used up one of those posts. */
+            for (int i = 1; i < group; ++i) sem_trywait(&S->customers);
+        } else {
+            lock_state();
+            if (S->waiting > 0) S->waiting--;  /* one student leaves the chair to get help */
+            metrics_waiting();
+            unlock_state();
 
-        /* Signal exactly one student that the TA is ready now. */
-        sem_post(&ta_ready);
+            /* Signal exactly one student that the TA is ready now. */
+            sem_post(&S->ta_ready);
+        }
+        atomic_fetch_add(&S->served, group);
+        atomic_fetch_add(&S->sessions, 1);
 
-        /* Provide help (simulate with sleep). */
-        printf("[TA  ] Helping a student...\n");
+        /* Provide help (simulate with sleep); a group takes as long as one student. */
+        if (group > 1) LOG("[TA  ] Helping a group of %d students...\n", group);
+        else LOG("[TA  ] Helping a student...\n");
         sleep_ms(rand_range(&(unsigned int){(unsigned int)time(NULL)}, HELP_MIN_MS, HELP_MAX_MS));
-        printf("[TA  ] Finished helping.\n");
+        LOG("[TA  ] Finished helping.\n");
+        METRICS_UPDATE(me,
+            me->state = A3_TA_NAPPING;
+            me->served += group;
+            me->sessions++;
+            me->busy_ns += now_ns() - help_start);
+        perfctr_stop(R_TA_HELP);
     }
 
     return NULL;
@@ -143,97 +421,94 @@ static void *student_thread(void *varg) {
     StudentArgs *args = (StudentArgs *)varg;
     int id = args->id;
     unsigned int rng = args->rng;
+    a3_slot *me = M ? &M->slots[id] : NULL;
 
     for (int k = 1; k <= args->requests_to_make; ++k) {
         /* Program for a while */
         int code_ms = rand_range(&rng, PROGRAM_MIN_MS, PROGRAM_MAX_MS);
-        printf("[Stu%02d] Programming (%d ms) before seeking help (%d/%d).\n",
+        LOG("[Stu%02d] Programming (%d ms) before seeking help (%d/%d).\n",
                id, code_ms, k, args->requests_to_make);
         sleep_ms(code_ms);
 
         /* Try to get help */
-        pthread_mutex_lock(&mtx);
-        if (waiting < NUM_CHAIRS) {
-            waiting++;
-            int pos = waiting; /* just for logging; not a real seat index */
-            printf("[Stu%02d] Found a chair (waiting=%d). Waking TA if asleep.\n", id, pos);
+        perfctr_start(R_STU_SEEK);
+        lock_state();
+        if (S->waiting < NUM_CHAIRS) {
+            S->waiting++;
+            int pos = S->waiting; /* just for logging; not a real seat index */
+            metrics_waiting();
+            METRICS_UPDATE(me, me->state = A3_STU_SEATED);
+            LOG("[Stu%02d] Found a chair (waiting=%d). Waking TA if asleep.\n", id, pos);
+            long long seated = now_ns();
             /* Signal that a student is waiting / arrived. This wakes the TA if sleeping. */
-            sem_post(&customers);
-            pthread_mutex_unlock(&mtx);
-
-            /* Wait until TA is ready for me */
-            sem_wait(&ta_ready);
+            sem_post(&S->customers);
+
+            if (BATCH_SIZE > 1) {
+                /* Wait until the TA admits my ticket (tickets are admitted in order). */
+                long long ticket = S->next_ticket++;
+                while (S->admitted <= ticket)
+                    recover_owner_dead(pthread_cond_wait(&S->admitted_cv, &S->mtx));
+                unlock_state();
+            } else {
+                unlock_state();
+
+                /* Wait until TA is ready for me */
+                sem_wait(&S->ta_ready);
+            }
+            atomic_fetch_add(&S->wait_ns, now_ns() - seated);
+            METRICS_UPDATE(me, me->state = A3_STU_PROGRAMMING; me->served++);
 
             /* I'm with the TA now */
-            printf("[Stu%02d] Getting help from the TA.\n", id);
+            LOG("[Stu%02d] Getting help from the TA.\n", id);
             /* actual help time is simulated by TA; student just proceeds */
         } else {
             /* No chair; leave and try later */
-            printf("[Stu%02d] No chairs available. Will come back later.\n", id);
-            pthread_mutex_unlock(&mtx);
+            LOG("[Stu%02d] No chairs available. Will come back later.\n", id);
+            atomic_fetch_add(&S->turned_away, 1);
+            METRICS_UPDATE(me, me->turned_away++);
+            unlock_state();
             /* Back to programming loop; we'll try again in next iteration (or you could retry here). */
         }
+        perfctr_stop(R_STU_SEEK);
     }
 
-    atomic_fetch_sub(&students_active, 1);
-    printf("[Stu%02d] Done for the day.\n", id);
+    METRICS_UPDATE(me, me->state = A3_STU_DONE);
+    atomic_fetch_sub(&S->students_active, 1);
+    LOG("[Stu%02d] Done for the day.\n", id);
     free(args);
     return NULL;
 }
 
-/* ---------- CLI parsing ---------- */
-static void parse_args(int argc, char **argv) {
-    int opt;
-    while ((opt = getopt(argc, argv, "s:c:r:h")) != -1) {
-        switch (opt) {
-            case 's': NUM_STUDENTS = atoi(optarg); break;
-            case 'c': NUM_CHAIRS   = atoi(optarg); break;
-            case 'r': REQS_PER_STUDENT = atoi(optarg); break;
-            case 'h':
-            default:
-                fprintf(stderr,
-                    "Usage: %s [-s students] [-c chairs] [-r requests_per_student]\n", argv[0]);
-                exit(opt == 'h' ? 0 : 1);
-        }
-    }
-    if (NUM_STUDENTS < 1) NUM_STUDENTS = 1;
-    if (NUM_CHAIRS   < 0) NUM_CHAIRS   = 0;
-    if (REQS_PER_STUDENT < 1) REQS_PER_STUDENT = 1;
+static StudentArgs *make_student_args(int i) {
+    StudentArgs *sa = malloc(sizeof(*sa));
+    if (!sa) { perror("malloc"); return NULL; }
+    sa->id = i + 1;
+    sa->rng = (unsigned int)(time(NULL) ^ (uintptr_t)sa ^ (i * 2654435761u) ^ (unsigned)getpid());
+    sa->requests_to_make = REQS_PER_STUDENT;
+    return sa;
 }
 
-/* ---------- Main ---------- */
-int main(int argc, char **argv) {
-    parse_args(argc, argv);
-
-    printf("Config: students=%d, chairs=%d, requests_per_student=%d\n",
-           NUM_STUDENTS, NUM_CHAIRS, REQS_PER_STUDENT);
-
-    if (sem_init(&customers, 0, 0) != 0) { perror("sem_init(customers)"); return 1; }
-    if (sem_init(&ta_ready,  0, 0) != 0) { perror("sem_init(ta_ready)");  return 1; }
+/* ---------- Runners: one TA and NUM_STUDENTS students, as threads or as processes ---------- */
 
+/* Returns after the last student is done; *students_done is taken at that point. */
+static int run_threads(struct timespec *students_done) {
     pthread_t ta;
     pthread_t *students = calloc((size_t)NUM_STUDENTS, sizeof(pthread_t));
-    if (!students) { perror("calloc"); return 1; }
-
-    atomic_store(&students_active, NUM_STUDENTS);
+    if (!students) { perror("calloc"); return -1; }
 
     /* Start TA */
     if (pthread_create(&ta, NULL, ta_thread, NULL) != 0) {
         perror("pthread_create(TA)");
-        return 1;
+        return -1;
     }
 
     /* Start students */
     for (int i = 0; i < NUM_STUDENTS; ++i) {
-        StudentArgs *sa = malloc(sizeof(*sa));
-        if (!sa) { perror("malloc"); return 1; }
-        sa->id = i + 1;
-        sa->rng = (unsigned int)(time(NULL) ^ (uintptr_t)sa ^ (i * 2654435761u));
-        sa->requests_to_make = REQS_PER_STUDENT;
-
+        StudentArgs *sa = make_student_args(i);
+        if (!sa) return -1;
         if (pthread_create(&students[i], NULL, student_thread, sa) != 0) {
             perror("pthread_create(student)");
-            return 1;
+            return -1;
         }
     }
 
@@ -242,12 +517,184 @@ int main(int argc, char **argv) {
         pthread_join(students[i], NULL);
     }
     free(students);
+    clock_gettime(CLOCK_MONOTONIC, students_done);
 
     /* Allow TA to finish when queue is empty and no students remain */
     pthread_join(ta, NULL);
-
-    sem_destroy(&customers);
-    sem_destroy(&ta_ready);
-    pthread_mutex_destroy(&mtx);
     return 0;
 }
+
+/* Run one role in a forked child and leave without running the parent's atexit work. */
+static pid_t fork_role(void *(*fn)(void *), void *arg) {
+    fflush(stdout);     /* otherwise buffered parent output is printed once per child */
+    pid_t pid = fork();
+    if (pid == 0) {
+        fn(arg);
+        fflush(stdout);
+        _exit(0);
+    }
+    if (pid < 0) perror("fork");
+    return pid;
+}
+
+static int run_processes(struct timespec *students_done) {
+    pid_t *students = calloc((size_t)NUM_STUDENTS, sizeof(pid_t));
+    if (!students) { perror("calloc"); return -1; }
+
+    pid_t ta = fork_role(ta_thread, NULL);
+    if (ta < 0) { free(students); return -1; }
+
+    int started = 0;
+    for (int i = 0; i < NUM_STUDENTS; ++i) {
+        /* The args are allocated here and freed by student_thread in the child. */
+        StudentArgs *sa = make_student_args(i);
+        if (!sa) break;
+        students[i] = fork_role(student_thread, sa);
+        free(sa);       /* the parent's copy */
+        if (students[i] < 0) break;
+        started++;
+    }
+    /* Students that were never started will not decrement the count themselves. */
+    if (started < NUM_STUDENTS) atomic_fetch_sub(&S->students_active, NUM_STUDENTS - started);
+
+    /* Reap in whatever order the children exit, so a TA that dies is noticed while
+     * students are still blocked waiting for it (no robust mutex helps with that). */
+    int failed = 0, students_left = started;
+    bool ta_alive = true, have_done_time = false;
+    while (students_left > 0 || ta_alive) {
+        int status;
+        pid_t pid = waitpid(-1, &status, 0);
+        if (pid < 0) {
+            if (errno == EINTR) continue;
+            perror("waitpid");
+            failed++;
+            break;
+        }
+        bool clean = WIFEXITED(status) && WEXITSTATUS(status) == 0;
+
+        if (pid == ta) {
+            ta_alive = false;
+            if (students_left > 0) {
+                fprintf(stderr, "[error] TA process exited %s with %d student(s) still running; stopping them\n",
+                        clean ? "early" : "abnormally", students_left);
+                for (int i = 0; i < started; ++i)
+                    if (students[i] > 0) kill(students[i], SIGKILL);
+                failed++;
+            } else if (!clean) {
+                fprintf(stderr, "[warn] TA process exited abnormally\n");
+                failed++;
+            }
+            continue;
+        }
+
+        for (int i = 0; i < started; ++i) {
+            if (students[i] != pid) continue;
+            students[i] = 0;
+            students_left--;
+            if (!clean && ta_alive) {
+                /* It died before saying it was done; do it for it so the TA can close. */
+                fprintf(stderr, "[warn] student process %d exited abnormally\n", (int)pid);
+                atomic_fetch_sub(&S->students_active, 1);
+                failed++;
+            }
+            break;
+        }
+        if (students_left == 0 && !have_done_time) {
+            clock_gettime(CLOCK_MONOTONIC, students_done);
+            have_done_time = true;
+        }
+    }
+    if (!have_done_time) clock_gettime(CLOCK_MONOTONIC, students_done);
+    free(students);
+    return (failed || started < NUM_STUDENTS) ? -1 : 0;
+}
+
+/* ---------- CLI parsing ---------- */
+static void parse_args(int argc, char **argv) {
+    int opt;
+    while ((opt = getopt(argc, argv, "s:c:r:Pb:qx:pmh")) != -1) {
+        switch (opt) {
+            case 's': NUM_STUDENTS = atoi(optarg); break;
+            case 'c': NUM_CHAIRS   = atoi(optarg); break;
+            case 'r': REQS_PER_STUDENT = atoi(optarg); break;
+            case 'P': PERF = true; break;
+            case 'b': BATCH_SIZE = atoi(optarg); break;
+            case 'q': QUIET = true; break;
+            case 'x': TIME_SCALE = atof(optarg); break;
+            case 'p': PROCESS_MODE = true; break;
+            case 'm': METRICS = true; break;
+            case 'h':
+            default:
+                fprintf(stderr,
+                    "Usage: %s [-s students] [-c chairs] [-r requests_per_student] [-P] [-b batch] [-q] [-x time_scale] [-p] [-m]\n", argv[0]);
+                exit(opt == 'h' ? 0 : 1);
+        }
+    }
+    if (NUM_STUDENTS < 1) NUM_STUDENTS = 1;
+    if (NUM_CHAIRS   < 0) NUM_CHAIRS   = 0;
+    if (REQS_PER_STUDENT < 1) REQS_PER_STUDENT = 1;
+    if (BATCH_SIZE < 1) BATCH_SIZE = 1;
+    if (TIME_SCALE < 0) TIME_SCALE = 0;
+}
+
+/* ---------- Main ---------- */
+int main(int argc, char **argv) {
+    parse_args(argc, argv);
+
+    printf("Config: students=%d, chairs=%d, requests_per_student=%d, batch=%d, mode=%s\n",
+           NUM_STUDENTS, NUM_CHAIRS, REQS_PER_STUDENT, BATCH_SIZE,
+           PROCESS_MODE ? "processes" : "threads");
+
+    /* Per-thread regions only see the calling process, so with -p one inherited
+     * region around the whole run counts the TA and every student once reaped. */
+    int r_processes = -1;
+    if (PERF && perfctr_init(PROCESS_MODE ? PERFCTR_INHERIT : 0) == 0) {
+        if (PROCESS_MODE) {
+            r_processes = perfctr_region("processes");
+        } else {
+            R_TA_NAP   = perfctr_region("ta_nap");
+            R_TA_HELP  = perfctr_region("ta_help");
+            R_STU_SEEK = perfctr_region("student_seek");
+        }
+    }
+
+    /* Shared state first: nothing can fail between creating the metrics name and the run. */
+    if (shared_init(PROCESS_MODE) != 0) return 1;
+    if (METRICS && metrics_init() != 0) return 1;
+    atomic_store(&S->students_active, NUM_STUDENTS);
+
+    /* For the summary: wall time until the last student is done, and context switches
+     * (the children's show up under RUSAGE_CHILDREN once they are reaped). */
+    struct rusage ru0, ru1, rc0, rc1;
+    struct timespec t0, t1;
+    getrusage(RUSAGE_SELF, &ru0);
+    getrusage(RUSAGE_CHILDREN, &rc0);
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+
+    perfctr_start(r_processes);
+    int rc = PROCESS_MODE ? run_processes(&t1) : run_threads(&t1);
+    perfctr_stop(r_processes);
+    if (rc != 0 && !PROCESS_MODE) { metrics_finish(); return 1; }
+
+    getrusage(RUSAGE_SELF, &ru1);
+    getrusage(RUSAGE_CHILDREN, &rc1);
+
+    int n_served = atomic_load(&S->served), n_sessions = atomic_load(&S->sessions);
+    double secs = (double)(t1.tv_sec - t0.tv_sec) + (double)(t1.tv_nsec - t0.tv_nsec) / 1e9;
+    long csw = (ru1.ru_nvcsw - ru0.ru_nvcsw) + (ru1.ru_nivcsw - ru0.ru_nivcsw)
+             + (rc1.ru_nvcsw - rc0.ru_nvcsw) + (rc1.ru_nivcsw - rc0.ru_nivcsw);
+    printf("Summary: %d requests served in %d sessions (%.2f per session), %d turned away\n",
+           n_served, n_sessions, n_sessions ? (double)n_served / n_sessions : 0.0,
+           atomic_load(&S->turned_away));
+    printf("         TA wakeups per request %.2f, context switches per request %.2f, %.2f requests/s\n",
+           n_served ? (double)n_sessions / n_served : 0.0,
+           n_served ? (double)csw / n_served : 0.0,
+           secs > 0 ? n_served / secs : 0.0);
+    printf("         mean wait from chair to TA %.1f us\n",
+           n_served ? (double)atomic_load(&S->wait_ns) / n_served / 1e3 : 0.0);
+
+    metrics_finish();
+    shared_destroy();
+    perfctr_report(stderr);
+    return rc == 0 ? 0 : 1;
+}
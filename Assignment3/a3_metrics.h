@@ -0,0 +1,92 @@
+/*  a3_metrics.h — live metrics segment shared by A3 (writer) and a3top (reader).
+ *
+ *  With -m, A3 creates the POSIX shared memory object "/a3-metrics-<pid>" holding one
+ *  a3_metrics header followed by one a3_slot per role: slot 0 is the TA, slot i is
+ *  student i. Each TA or student is the only writer of its own slot, and every slot
+ *  and the header's mutable part sit on their own cache line. Publishing an update
+ *  therefore touches only a line the writer already owns, and the reader never
+ *  writes to the segment at all.
+ *
+ *  Each slot and the header's live part is guarded by a sequence count (seqlock):
+ *  the writer makes `seq` odd, updates the fields, then makes it even again. A reader
+ *  copies the fields and retries if `seq` was odd or changed meanwhile. Writers never
+ *  wait for readers.
+ */
+#ifndef A3_METRICS_H
+#define A3_METRICS_H
+
+#include <stdatomic.h>
+#include <string.h>
+
+#define A3_METRICS_NAME_FMT  "/a3-metrics-%d"      /* A3's pid */
+#define A3_METRICS_MAGIC     0x4133344du           /* "A34M" */
+#define A3_METRICS_VERSION   1
+#define A3_CACHE_LINE        64
+
+enum a3_state {
+    A3_TA_NAPPING = 1, A3_TA_HELPING, A3_TA_CLOSED,
+    A3_STU_PROGRAMMING, A3_STU_SEATED, A3_STU_DONE
+};
+
+typedef struct {
+    _Alignas(A3_CACHE_LINE) atomic_uint seq;
+    int state;                  /* enum a3_state */
+    long long served;           /* TA: students helped; student: times helped */
+    long long turned_away;      /* student: found no free chair */
+    long long sessions;         /* TA: help sessions */
+    long long busy_ns;          /* TA: time spent helping */
+} a3_slot;
+
+/* Shared queue state; written under the simulation's mutex, which also serializes the writers. */
+typedef struct {
+    _Alignas(A3_CACHE_LINE) atomic_uint seq;
+    int waiting;                /* students currently in chairs */
+    int finished;               /* set once the run is over */
+} a3_live;
+
+typedef struct {
+    /* Written once before any thread or process starts. */
+    unsigned magic, version;
+    int pid;
+    int nslots;                 /* 1 TA + students */
+    int chairs, batch;
+    long long start_ns;         /* CLOCK_MONOTONIC */
+
+    a3_live live;
+
+    _Alignas(A3_CACHE_LINE) a3_slot slots[];
+} a3_metrics;
+
+static inline size_t a3_metrics_size(int nslots) {
+    return sizeof(a3_metrics) + (size_t)nslots * sizeof(a3_slot);
+}
+
+/* ---------- Writer side ---------- */
+
+static inline void a3_seq_begin(atomic_uint *seq) {
+    atomic_store_explicit(seq, atomic_load_explicit(seq, memory_order_relaxed) + 1,
+                          memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);  /* odd seq is visible before the fields change */
+}
+
+static inline void a3_seq_end(atomic_uint *seq) {
+    atomic_store_explicit(seq, atomic_load_explicit(seq, memory_order_relaxed) + 1,
+                          memory_order_release);
+}
+
+/* ---------- Reader side ---------- */
+
+/* Copy the n-byte object src (an a3_slot or a3_live, seq included) guarded by seq into dst.
+ * Returns 0, or -1 if no stable copy was seen. */
+static inline int a3_seq_read(const atomic_uint *seq, void *dst, const void *src, size_t n) {
+    for (int tries = 0; tries < 1000; ++tries) {
+        unsigned s0 = atomic_load_explicit(seq, memory_order_acquire);
+        if (s0 & 1) continue;
+        memcpy(dst, src, n);
+        atomic_thread_fence(memory_order_acquire);  /* the copy completes before seq is re-read */
+        if (atomic_load_explicit(seq, memory_order_relaxed) == s0) return 0;
+    }
+    return -1;
+}
+
+#endif /* A3_METRICS_H */
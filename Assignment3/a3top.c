@@ -0,0 +1,184 @@
+/*  a3top.c  — live view of a running A3 started with -m
+ *
+ *  Compile:
+ *      gcc -std=c11 -O2 -o a3top a3top.c
+ *
+ *  Run (examples):
+ *      ./A3 -s 50 -r 100 -q -m & ./a3top $!     # one line per second until A3 exits
+ *      ./a3top -i 200 -S 100 1234               # report every 200 ms, sample every 100 us
+ *
+ *  Flags:
+ *      -i <ms>    report interval                    (default 1000)
+ *      -S <us>    sampling interval for `waiting`    (default 1000)
+ *
+ *  Notes:
+ *    - The segment is mapped read-only; samples are lock-free seqlock reads, so
+ *      sampling never blocks or slows down the simulation (see a3_metrics.h).
+ *    - The queue length is sampled every -S microseconds and reported as the mean
+ *      and maximum over each interval; short bursts that a per-second look would miss
+ *      still show up in the maximum. The per-slot counters are summed once per report.
+ *    - Exits when A3 marks the run finished or the A3 process is gone.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <unistd.h>
+#include <time.h>
+#include <errno.h>
+#include <signal.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "a3_metrics.h"
+
+static long long now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+/* Totals over all slots at one instant (each slot is read consistently on its own). */
+typedef struct {
+    long long served, turned_away, sessions, ta_busy_ns;
+    int active, ta_state;
+} Totals;
+
+static void read_totals(const a3_metrics *m, Totals *t) {
+    *t = (Totals){ 0 };
+    for (int i = 0; i < m->nslots; ++i) {
+        a3_slot s;
+        if (a3_seq_read(&m->slots[i].seq, &s, &m->slots[i], sizeof(s)) != 0) continue;
+        if (i == 0) {
+            t->served     = s.served;
+            t->sessions   = s.sessions;
+            t->ta_busy_ns = s.busy_ns;
+            t->ta_state   = s.state;
+        } else {
+            t->turned_away += s.turned_away;
+            if (s.state != A3_STU_DONE) t->active++;
+        }
+    }
+}
+
+static const char *ta_state_name(int state) {
+    switch (state) {
+        case A3_TA_NAPPING: return "napping";
+        case A3_TA_HELPING: return "helping";
+        case A3_TA_CLOSED:  return "closed";
+        default:            return "?";
+    }
+}
+
+static void usage(const char *prog) {
+    fprintf(stderr, "Usage: %s [-i report_ms] [-S sample_us] <A3 pid>\n", prog);
+}
+
+int main(int argc, char **argv) {
+    int report_ms = 1000, sample_us = 1000;
+    int opt;
+    while ((opt = getopt(argc, argv, "i:S:h")) != -1) {
+        switch (opt) {
+            case 'i': report_ms = atoi(optarg); break;
+            case 'S': sample_us = atoi(optarg); break;
+            case 'h':
+            default:
+                usage(argv[0]);
+                exit(opt == 'h' ? 0 : 1);
+        }
+    }
+    if (optind >= argc) { usage(argv[0]); return 1; }
+    if (report_ms < 1) report_ms = 1;
+    if (sample_us < 1) sample_us = 1;
+
+    pid_t pid = (pid_t)atoi(argv[optind]);
+    char name[64];
+    snprintf(name, sizeof(name), A3_METRICS_NAME_FMT, (int)pid);
+
+    /* A3 may just have been started in the background; give it a moment to create the segment. */
+    int fd = -1;
+    for (int tries = 0; tries < 200 && fd < 0; ++tries) {
+        fd = shm_open(name, O_RDONLY, 0);
+        if (fd < 0 && errno == ENOENT) {
+            nanosleep(&(struct timespec){ 0, 10 * 1000000L }, NULL);
+            continue;
+        }
+        if (fd < 0) break;
+    }
+    if (fd < 0) { perror(name); return 1; }
+
+    /* The size is set right after creation; wait for it, then for the header's magic. */
+    struct stat st;
+    for (int tries = 0; fstat(fd, &st) == 0 && (size_t)st.st_size < sizeof(a3_metrics) && tries < 200; ++tries)
+        nanosleep(&(struct timespec){ 0, 10 * 1000000L }, NULL);
+    if ((size_t)st.st_size < sizeof(a3_metrics)) { fprintf(stderr, "%s: segment too small\n", name); return 1; }
+
+    const a3_metrics *m = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (m == MAP_FAILED) { perror("mmap"); return 1; }
+
+    for (int tries = 0; m->magic != A3_METRICS_MAGIC && tries < 200; ++tries)
+        nanosleep(&(struct timespec){ 0, 10 * 1000000L }, NULL);
+    atomic_thread_fence(memory_order_acquire);
+    if (m->magic != A3_METRICS_MAGIC || m->version != A3_METRICS_VERSION ||
+        a3_metrics_size(m->nslots) > (size_t)st.st_size) {
+        fprintf(stderr, "%s: unexpected layout\n", name);
+        return 1;
+    }
+
+    printf("A3 pid %d: %d students, %d chairs, batch %d\n", m->pid, m->nslots - 1, m->chairs, m->batch);
+
+    Totals prev;
+    read_totals(m, &prev);
+    long long last_report = now_ns();
+    long long next_sample = last_report;
+    long long wait_sum = 0, samples = 0;
+    int wait_max = 0;
+    bool finished = false;
+
+    while (!finished) {
+        a3_live live;
+        if (a3_seq_read(&m->live.seq, &live, &m->live, sizeof(live)) == 0) {
+            wait_sum += live.waiting;
+            if (live.waiting > wait_max) wait_max = live.waiting;
+            samples++;
+            finished = live.finished;
+        }
+        if (!finished && kill(pid, 0) != 0 && errno == ESRCH) {
+            fprintf(stderr, "A3 pid %d is gone\n", (int)pid);
+            finished = true;
+        }
+
+        long long now = now_ns();
+        if (finished || now - last_report >= (long long)report_ms * 1000000LL) {
+            Totals cur;
+            read_totals(m, &cur);
+            double dt = (double)(now - last_report) / 1e9;
+            long long d_served = cur.served - prev.served;
+            printf("%8.2fs  waiting %5.2f avg %3d max  active %3d  served %7lld (%7.1f/s)  "
+                   "turned away %7lld  sessions %7lld  TA busy %5.1f%% (%s)\n",
+                   (double)(now - m->start_ns) / 1e9,
+                   samples ? (double)wait_sum / (double)samples : 0.0, wait_max,
+                   cur.active, cur.served, dt > 0 ? (double)d_served / dt : 0.0,
+                   cur.turned_away, cur.sessions,
+                   dt > 0 ? 100.0 * (double)(cur.ta_busy_ns - prev.ta_busy_ns) / 1e9 / dt : 0.0,
+                   ta_state_name(cur.ta_state));
+            fflush(stdout);
+            prev = cur;
+            last_report = now;
+            wait_sum = samples = 0;
+            wait_max = 0;
+        }
+
+        /* Absolute deadlines, so the sampling rate does not drift with the work done per sample. */
+        next_sample += (long long)sample_us * 1000LL;
+        if (next_sample < now) next_sample = now;
+        struct timespec ts = { (time_t)(next_sample / 1000000000LL), (long)(next_sample % 1000000000LL) };
+        while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR) {}
+    }
+
+    munmap((void *)m, (size_t)st.st_size);
+    return 0;
+}
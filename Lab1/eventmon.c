@@ -0,0 +1,170 @@
+// eventmon.c — consume process fork/exec/exit events from /dev/simple_events (simple.ko).
+// Build:   gcc -Wall -Wextra -std=c11 -O2 -o eventmon eventmon.c
+// Run:     sudo insmod simple.ko && sudo ./eventmon          # rates once per second
+//          sudo ./eventmon -v                                # also print every event
+//          sudo ./eventmon -d 10 -i 500                      # 10 s, report every 0.5 s
+//
+// Flags:
+//   -v           print each event
+//   -i <ms>      report interval (default 1000)
+//   -d <sec>     stop after this many seconds (default: run until Ctrl-C)
+//
+// The rings are mapped once; after that the only syscall is poll(), made when
+// every ring is empty. Each report line shows events per second by type and
+// how many events the kernel dropped because a ring was full.
+
+#define _POSIX_C_SOURCE 200809L
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#include "simple_uapi.h"
+
+static volatile sig_atomic_t stop;
+
+static void on_signal(int sig) { (void)sig; stop = 1; }
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static const char* type_name(unsigned type) {
+    switch (type) {
+        case SIMPLE_EV_FORK: return "fork";
+        case SIMPLE_EV_EXEC: return "exec";
+        case SIMPLE_EV_EXIT: return "exit";
+        default:             return "?";
+    }
+}
+
+typedef struct {
+    const struct simple_events_info* info;  // page 0, read-only
+    char* rings;                            // mapped from info->ring_offset
+    size_t rings_size;
+} event_map;
+
+static struct simple_ring_hdr* ring_at(const event_map* m, unsigned i) {
+    return (struct simple_ring_hdr*)(m->rings + (size_t)i * m->info->ring_stride);
+}
+
+// Drain every ring; counts[type] gets one per event. Returns the number consumed.
+static unsigned long long drain(const event_map* m, unsigned long long counts[4], int verbose) {
+    unsigned long long total = 0;
+    for (unsigned i = 0; i < m->info->nrings; ++i) {
+        struct simple_ring_hdr* r = ring_at(m, i);
+        const struct simple_event* ev = (const struct simple_event*)((char*)r + m->info->events_offset);
+        __u64 head = __atomic_load_n(&r->head, __ATOMIC_ACQUIRE);
+        __u64 tail = r->tail;
+        for (; tail != head; ++tail) {
+            const struct simple_event* e = &ev[tail & (m->info->nslots - 1)];
+            if (e->type < 4) counts[e->type]++;
+            if (verbose) {
+                printf("%llu.%09llu cpu%-3u %-4s pid %-7d tgid %-7d aux %-7d %.16s\n",
+                       (unsigned long long)(e->ts_ns / 1000000000ULL),
+                       (unsigned long long)(e->ts_ns % 1000000000ULL),
+                       e->cpu, type_name(e->type), e->pid, e->tgid, e->aux, e->comm);
+            }
+            total++;
+        }
+        __atomic_store_n(&r->tail, tail, __ATOMIC_RELEASE);   // hand the slots back
+    }
+    return total;
+}
+
+static unsigned long long total_dropped(const event_map* m) {
+    unsigned long long d = 0;
+    for (unsigned i = 0; i < m->info->nrings; ++i) d += __atomic_load_n(&ring_at(m, i)->dropped, __ATOMIC_RELAXED);
+    return d;
+}
+
+int main(int argc, char** argv) {
+    int verbose = 0, interval_ms = 1000;
+    double duration = 0;
+
+    int c;
+    while ((c = getopt(argc, argv, "vi:d:h")) != -1) {
+        switch (c) {
+            case 'v': verbose = 1; break;
+            case 'i': interval_ms = atoi(optarg); break;
+            case 'd': duration = atof(optarg); break;
+            default:
+                fprintf(stderr, "Usage: %s [-v] [-i interval_ms] [-d seconds]\n", argv[0]);
+                return c == 'h' ? 0 : EXIT_FAILURE;
+        }
+    }
+    if (interval_ms < 10) interval_ms = 10;
+
+    const char* dev = "/dev/" SIMPLE_EVENTS_DEV;
+    int fd = open(dev, O_RDWR);
+    if (fd < 0) { perror(dev); return EXIT_FAILURE; }
+
+    // The info page is read-only; it gives the geometry to map the rings read-write.
+    long page = sysconf(_SC_PAGESIZE);
+    event_map m;
+    m.info = mmap(NULL, (size_t)page, PROT_READ, MAP_SHARED, fd, 0);
+    if (m.info == MAP_FAILED) { perror("mmap"); return EXIT_FAILURE; }
+    if (m.info->magic != SIMPLE_EVENTS_MAGIC || m.info->version != SIMPLE_EVENTS_VERSION ||
+        m.info->event_size != sizeof(struct simple_event)) {
+        fprintf(stderr, "%s: unexpected layout (version %u)\n", dev, m.info->version);
+        return EXIT_FAILURE;
+    }
+    m.rings_size = (size_t)(m.info->map_size - m.info->ring_offset);
+    m.rings = mmap(NULL, m.rings_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, (off_t)m.info->ring_offset);
+    if (m.rings == MAP_FAILED) { perror("mmap"); return EXIT_FAILURE; }
+    printf("%u rings x %u events, %zu KiB mapped\n", m.info->nrings, m.info->nslots,
+           (m.rings_size + (size_t)page) / 1024);
+
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = on_signal;
+    sigaction(SIGINT, &sa, NULL);
+    sigaction(SIGTERM, &sa, NULL);
+
+    unsigned long long counts[4] = { 0 }, last[4] = { 0 }, all = 0;
+    unsigned long long dropped0 = total_dropped(&m), last_dropped = dropped0;
+    double start = now_sec(), last_report = start;
+
+    while (!stop) {
+        unsigned long long got = drain(&m, counts, verbose);
+        all += got;
+
+        double now = now_sec();
+        if (now - last_report >= interval_ms / 1000.0) {
+            double dt = now - last_report;
+            unsigned long long d = total_dropped(&m);
+            printf("fork %8.0f/s  exec %8.0f/s  exit %8.0f/s  dropped %llu (+%llu)\n",
+                   (double)(counts[SIMPLE_EV_FORK] - last[SIMPLE_EV_FORK]) / dt,
+                   (double)(counts[SIMPLE_EV_EXEC] - last[SIMPLE_EV_EXEC]) / dt,
+                   (double)(counts[SIMPLE_EV_EXIT] - last[SIMPLE_EV_EXIT]) / dt,
+                   d - dropped0, d - last_dropped);
+            fflush(stdout);
+            memcpy(last, counts, sizeof(last));
+            last_dropped = d;
+            last_report = now;
+        }
+        if (duration > 0 && now - start >= duration) break;
+        if (got) continue;   // more may already be queued; poll only once the rings ran dry
+
+        // Sleep only until the next report is due; events wake us earlier.
+        int timeout = (int)((last_report + interval_ms / 1000.0 - now) * 1000.0) + 1;
+        struct pollfd pfd = { fd, POLLIN, 0 };
+        poll(&pfd, 1, timeout > 0 ? timeout : 1);
+    }
+
+    double secs = now_sec() - start;
+    printf("%llu events in %.1f s (%.0f/s), %llu dropped\n",
+           all, secs, secs > 0 ? (double)all / secs : 0.0, total_dropped(&m) - dropped0);
+
+    munmap(m.rings, m.rings_size);
+    munmap((void*)m.info, (size_t)page);
+    close(fd);
+    return 0;
+}
@@ -1,5 +1,21 @@
 // simple.c — Part-2: Process Representation in Linux
-// Prints selected task_struct fields for the init (swapper/idle) task.
+// Prints selected task_struct fields for the init (swapper/idle) task, and
+// exposes a snapshot of every task through two /proc files:
+//   /proc/simple_tasks      text, one line per task
+//   /proc/simple_tasks.bin  binary, layout in simple_uapi.h
+// Each open takes one snapshot under RCU, so a reader gets all tasks in a
+// single pass instead of opening /proc/<pid>/stat for each of them.
+//
+// It also hooks the sched_process_fork/exec/exit tracepoints and writes one
+// fixed-size record per event into a per-CPU ring. /dev/simple_events maps
+// the rings into the consumer (see eventmon.c), which polls for data and never
+// makes a syscall per event.
+//
+// Finally, writing a tgid to /sys/module/simple/parameters/target_tgid starts
+// a sampler that records every thread's runtime, run-queue wait, context
+// switches and last CPU each sample_ms; /proc/simple_threads shows the
+// per-thread deltas between the last two samples. Sampling stops when the
+// process exits, until another tgid is written.
 
 #include <linux/init.h>
 #include <linux/module.h>
@@ -8,9 +24,33 @@
 #include <linux/sched.h>         // task_struct
 #include <linux/sched/task.h>    // init_task
 #include <linux/printk.h>
+#include <linux/sched/signal.h>  // for_each_process_thread
+#include <linux/rcupdate.h>
+#include <linux/proc_fs.h>
+#include <linux/seq_file.h>
+#include <linux/fs.h>
+#include <linux/mm.h>
+#include <linux/slab.h>          // kvmalloc/kvfree
+#include <linux/overflow.h>      // struct_size
+#include <linux/timekeeping.h>
+#include <linux/tracepoint.h>
+#include <linux/miscdevice.h>
+#include <linux/vmalloc.h>
+#include <linux/poll.h>
+#include <linux/irq_work.h>
+#include <linux/log2.h>
+#include <linux/wait.h>
+#include <linux/workqueue.h>
+#include <linux/mutex.h>
+#include <linux/pid.h>
+#include <linux/pid_namespace.h>
+#include <linux/sort.h>
+#include <linux/bsearch.h>
+
+#include "simple_uapi.h"
 
 MODULE_LICENSE("GPL");
-MODULE_DESCRIPTION("Simple Module: print init_task fields");
+MODULE_DESCRIPTION("Simple Module: print init_task fields, snapshot all tasks via /proc, stream process events");
 MODULE_AUTHOR("You");
 
 /* Return numeric state compatible with newer kernels where t->state is hidden */
@@ -24,9 +64,713 @@ static unsigned long task_state_num(const struct task_struct *t)
     #endif
 }
 
+/* ---------- Task snapshots ---------- */
+
+/* Header and records are contiguous, so the .bin file is just this buffer. */
+struct task_snapshot {
+    struct simple_tasks_hdr hdr;
+    struct simple_task_rec recs[];
+};
+
+static void fill_rec(struct simple_task_rec *r, const struct task_struct *t)
+{
+    r->pid         = t->pid;
+    r->tgid        = t->tgid;
+    r->state       = (__u32)task_state_num(t) | (__u32)READ_ONCE(t->exit_state);
+    r->policy      = t->policy;
+    r->rt_priority = t->rt_priority;
+    r->flags       = t->flags;
+    r->utime_ns    = t->utime;   /* raw accounting, not task_cputime_adjusted() */
+    r->stime_ns    = t->stime;
+    r->nvcsw       = t->nvcsw;
+    r->nivcsw      = t->nivcsw;
+}
+
+/* Count under RCU, allocate outside it (kvmalloc may sleep), then fill under
+ * RCU again. Tasks can be created in between, so leave some slack and start
+ * over with a bigger buffer if it still overflows.
+ */
+static struct task_snapshot *take_snapshot(void)
+{
+    struct task_struct *p, *t;
+    struct task_snapshot *snap;
+    size_t cap = 0, n;
+    int tries;
+
+    rcu_read_lock();
+    for_each_process_thread(p, t)
+        cap++;
+    rcu_read_unlock();
+
+    for (tries = 0; tries < 4; tries++) {
+        cap += cap / 8 + 64;
+        snap = kvmalloc(struct_size(snap, recs, cap), GFP_KERNEL);
+        if (!snap)
+            return ERR_PTR(-ENOMEM);
+
+        n = 0;
+        rcu_read_lock();
+        for_each_process_thread(p, t) {
+            if (n == cap)
+                goto overflow;   /* a plain break would only leave the inner loop */
+            fill_rec(&snap->recs[n++], t);
+        }
+        rcu_read_unlock();
+
+        snap->hdr.magic    = SIMPLE_TASKS_MAGIC;
+        snap->hdr.version  = SIMPLE_TASKS_VERSION;
+        snap->hdr.rec_size = sizeof(struct simple_task_rec);
+        snap->hdr.count    = (__u32)n;
+        snap->hdr.taken_ns = ktime_get_ns();
+        return snap;
+
+overflow:
+        rcu_read_unlock();
+        kvfree(snap);
+        cap *= 2;
+    }
+    return ERR_PTR(-EAGAIN);
+}
+
+static size_t snapshot_bytes(const struct task_snapshot *snap)
+{
+    return struct_size(snap, recs, snap->hdr.count);
+}
+
+/* Text file: a seq_file walking the snapshot, one line per record. */
+
+static void *tasks_seq_start(struct seq_file *m, loff_t *pos)
+{
+    struct task_snapshot *snap = m->private;
+
+    if (*pos == 0)
+        return SEQ_START_TOKEN;
+    return *pos <= snap->hdr.count ? &snap->recs[*pos - 1] : NULL;
+}
+
+static void *tasks_seq_next(struct seq_file *m, void *v, loff_t *pos)
+{
+    ++*pos;
+    return tasks_seq_start(m, pos);
+}
+
+static void tasks_seq_stop(struct seq_file *m, void *v)
+{
+}
+
+static int tasks_seq_show(struct seq_file *m, void *v)
+{
+    const struct simple_task_rec *r = v;
+
+    if (v == SEQ_START_TOKEN) {
+        seq_puts(m, "pid tgid state policy rt_priority flags utime_ns stime_ns nvcsw nivcsw\n");
+        return 0;
+    }
+    seq_printf(m, "%d %d %u %u %u %#x %llu %llu %llu %llu\n",
+               r->pid, r->tgid, r->state, r->policy, r->rt_priority, r->flags,
+               (unsigned long long)r->utime_ns, (unsigned long long)r->stime_ns,
+               (unsigned long long)r->nvcsw, (unsigned long long)r->nivcsw);
+    return 0;
+}
+
+static const struct seq_operations tasks_seq_ops = {
+    .start = tasks_seq_start,
+    .next  = tasks_seq_next,
+    .stop  = tasks_seq_stop,
+    .show  = tasks_seq_show,
+};
+
+static int tasks_open(struct inode *inode, struct file *file)
+{
+    struct task_snapshot *snap = take_snapshot();
+    int ret;
+
+    if (IS_ERR(snap))
+        return PTR_ERR(snap);
+    ret = seq_open(file, &tasks_seq_ops);
+    if (ret) {
+        kvfree(snap);
+        return ret;
+    }
+    ((struct seq_file *)file->private_data)->private = snap;
+    return 0;
+}
+
+static int tasks_release(struct inode *inode, struct file *file)
+{
+    kvfree(((struct seq_file *)file->private_data)->private);
+    return seq_release(inode, file);
+}
+
+/* Binary file: the snapshot buffer as is. */
+
+static int tasks_bin_open(struct inode *inode, struct file *file)
+{
+    struct task_snapshot *snap = take_snapshot();
+
+    if (IS_ERR(snap))
+        return PTR_ERR(snap);
+    file->private_data = snap;
+    return 0;
+}
+
+static ssize_t tasks_bin_read(struct file *file, char __user *buf, size_t len, loff_t *pos)
+{
+    struct task_snapshot *snap = file->private_data;
+
+    return simple_read_from_buffer(buf, len, pos, snap, snapshot_bytes(snap));
+}
+
+static int tasks_bin_release(struct inode *inode, struct file *file)
+{
+    kvfree(file->private_data);
+    return 0;
+}
+
+/* proc_create() takes struct proc_ops from 5.6 on, struct file_operations before. */
+#if LINUX_VERSION_CODE >= KERNEL_VERSION(5,6,0)
+static const struct proc_ops tasks_fops = {
+    .proc_open    = tasks_open,
+    .proc_read    = seq_read,
+    .proc_lseek   = seq_lseek,
+    .proc_release = tasks_release,
+};
+
+static const struct proc_ops tasks_bin_fops = {
+    .proc_open    = tasks_bin_open,
+    .proc_read    = tasks_bin_read,
+    .proc_lseek   = default_llseek,
+    .proc_release = tasks_bin_release,
+};
+#else
+static const struct file_operations tasks_fops = {
+    .owner   = THIS_MODULE,
+    .open    = tasks_open,
+    .read    = seq_read,
+    .llseek  = seq_lseek,
+    .release = tasks_release,
+};
+
+static const struct file_operations tasks_bin_fops = {
+    .owner   = THIS_MODULE,
+    .open    = tasks_bin_open,
+    .read    = tasks_bin_read,
+    .llseek  = default_llseek,
+    .release = tasks_bin_release,
+};
+#endif
+
+/* ---------- Process lifecycle events ---------- */
+
+static unsigned int ring_slots = 4096;
+module_param(ring_slots, uint, 0444);
+MODULE_PARM_DESC(ring_slots, "events per CPU ring, rounded up to a power of two (default 4096)");
+
+#define EV_RING_HDR_BYTES 256   /* simple_ring_hdr, padded; events start after it */
+
+static void *ev_buf;            /* vmalloc_user: info page, then one ring per possible CPU */
+static size_t ev_buf_size;
+static struct simple_events_info *ev_info;
+/* The producer's own copy of the geometry. ev_info only publishes it: the
+ * kernel never reads anything back from a page user space can map.
+ */
+static unsigned int ev_nslots;
+static size_t ev_stride;
+static DECLARE_WAIT_QUEUE_HEAD(ev_wait);
+static struct irq_work ev_irq_work;
+static atomic_t ev_busy = ATOMIC_INIT(0);   /* one consumer at a time */
+
+static struct simple_ring_hdr *ev_ring(unsigned int cpu)
+{
+    return ev_buf + PAGE_SIZE + (size_t)cpu * ev_stride;
+}
+
+static void ev_wake(struct irq_work *work)
+{
+    wake_up_interruptible(&ev_wait);
+}
+
+/* The ring header is mapped writable, so head and tail are only ever used
+ * masked or compared, and the mask and offsets come from the statics above:
+ * a misbehaving consumer can lose events, not make the kernel write outside
+ * the ring.
+ */
+static void ev_emit(u32 type, const struct task_struct *p, s32 aux)
+{
+    struct simple_ring_hdr *r;
+    struct simple_event *e;
+    unsigned long flags;
+    u64 head;
+
+    local_irq_save(flags);      /* the only writer of this CPU's ring */
+    r = ev_ring(smp_processor_id());
+    head = r->head;
+    if (head - smp_load_acquire(&r->tail) >= ev_nslots) {
+        WRITE_ONCE(r->dropped, r->dropped + 1);
+        local_irq_restore(flags);
+        return;
+    }
+
+    e = (struct simple_event *)((char *)r + EV_RING_HDR_BYTES) + (head & (ev_nslots - 1));
+    e->ts_ns    = ktime_get_ns();
+    e->type     = type;
+    e->cpu      = smp_processor_id();
+    e->pid      = p->pid;
+    e->tgid     = p->tgid;
+    e->aux      = aux;
+    e->reserved = 0;
+    memcpy(e->comm, p->comm, sizeof(e->comm));
+    e->comm[sizeof(e->comm) - 1] = '\0';
+    smp_store_release(&r->head, head + 1);
+    local_irq_restore(flags);
+
+    /* These tracepoints can fire with scheduler locks held, so never wake
+     * the consumer directly; irq_work does it once we are out of here.
+     */
+    if (wq_has_sleeper(&ev_wait))
+        irq_work_queue(&ev_irq_work);
+}
+
+static void probe_fork(void *data, struct task_struct *parent, struct task_struct *child)
+{
+    ev_emit(SIMPLE_EV_FORK, child, parent->pid);
+}
+
+static void probe_exec(void *data, struct task_struct *p, pid_t old_pid, struct linux_binprm *bprm)
+{
+    ev_emit(SIMPLE_EV_EXEC, p, old_pid);
+}
+
+/* 6.16 added group_dead to sched_process_exit */
+#if LINUX_VERSION_CODE >= KERNEL_VERSION(6,16,0)
+static void probe_exit(void *data, struct task_struct *p, bool group_dead)
+#else
+static void probe_exit(void *data, struct task_struct *p)
+#endif
+{
+    ev_emit(SIMPLE_EV_EXIT, p, p->exit_code);
+}
+
+/* The sched tracepoints are not exported to modules by symbol, so look them
+ * up by name among the kernel's tracepoints.
+ */
+static struct {
+    const char *name;
+    void *probe;
+    struct tracepoint *tp;
+    bool registered;
+} ev_probes[] = {
+    { "sched_process_fork", probe_fork },
+    { "sched_process_exec", probe_exec },
+    { "sched_process_exit", probe_exit },
+};
+
+static void ev_find_tp(struct tracepoint *tp, void *priv)
+{
+    int i;
+
+    for (i = 0; i < ARRAY_SIZE(ev_probes); i++)
+        if (!strcmp(tp->name, ev_probes[i].name))
+            ev_probes[i].tp = tp;
+}
+
+static int ev_open(struct inode *inode, struct file *file)
+{
+    return atomic_cmpxchg(&ev_busy, 0, 1) ? -EBUSY : 0;
+}
+
+static int ev_release(struct inode *inode, struct file *file)
+{
+    atomic_set(&ev_busy, 0);
+    return 0;
+}
+
+/* Page 0 (the info page) may only be mapped read-only; the rings, whose tail
+ * words the consumer writes, are mapped from ring_offset on.
+ */
+static int ev_mmap(struct file *file, struct vm_area_struct *vma)
+{
+    unsigned long size = vma->vm_end - vma->vm_start;
+
+    if (vma->vm_pgoff >= (ev_buf_size >> PAGE_SHIFT) ||
+        size > ev_buf_size - (vma->vm_pgoff << PAGE_SHIFT))
+        return -EINVAL;
+    if (vma->vm_pgoff == 0) {
+        if (vma->vm_flags & VM_WRITE)
+            return -EPERM;
+        /* and no mprotect(PROT_WRITE) later */
+#if LINUX_VERSION_CODE >= KERNEL_VERSION(6,3,0)
+        vm_flags_clear(vma, VM_MAYWRITE);
+#else
+        vma->vm_flags &= ~VM_MAYWRITE;
+#endif
+    }
+    return remap_vmalloc_range(vma, ev_buf, vma->vm_pgoff);
+}
+
+static __poll_t ev_poll(struct file *file, poll_table *wait)
+{
+    unsigned int cpu;
+
+    poll_wait(file, &ev_wait, wait);
+    for_each_possible_cpu(cpu) {
+        struct simple_ring_hdr *r = ev_ring(cpu);
+
+        if (smp_load_acquire(&r->head) != READ_ONCE(r->tail))
+            return EPOLLIN | EPOLLRDNORM;
+    }
+    return 0;
+}
+
+static const struct file_operations ev_fops = {
+    .owner   = THIS_MODULE,
+    .open    = ev_open,
+    .release = ev_release,
+    .mmap    = ev_mmap,
+    .poll    = ev_poll,
+    .llseek  = noop_llseek,
+};
+
+static struct miscdevice ev_dev = {
+    .minor = MISC_DYNAMIC_MINOR,
+    .name  = SIMPLE_EVENTS_DEV,
+    .fops  = &ev_fops,
+    .mode  = 0600,      /* the consumer maps it read-write to publish tail */
+};
+
+static void events_unregister_probes(void)
+{
+    int i;
+
+    for (i = 0; i < ARRAY_SIZE(ev_probes); i++) {
+        if (ev_probes[i].registered)
+            tracepoint_probe_unregister(ev_probes[i].tp, ev_probes[i].probe, NULL);
+        ev_probes[i].registered = false;
+    }
+    tracepoint_synchronize_unregister();   /* no probe is still running */
+    irq_work_sync(&ev_irq_work);
+}
+
+static int events_init(void)
+{
+    unsigned int nslots, cpu;
+    size_t stride;
+    int i, ret;
+
+    BUILD_BUG_ON(sizeof(struct simple_ring_hdr) > EV_RING_HDR_BYTES);
+    BUILD_BUG_ON(sizeof(struct simple_events_info) > PAGE_SIZE);
+
+    nslots = roundup_pow_of_two(clamp(ring_slots, 64u, 1u << 20));
+    stride = PAGE_ALIGN(EV_RING_HDR_BYTES + (size_t)nslots * sizeof(struct simple_event));
+    ev_buf_size = PAGE_SIZE + (size_t)nr_cpu_ids * stride;
+    ev_buf = vmalloc_user(ev_buf_size);     /* zeroed */
+    if (!ev_buf)
+        return -ENOMEM;
+
+    ev_nslots = nslots;
+    ev_stride = stride;
+    ev_info = ev_buf;
+    ev_info->magic         = SIMPLE_EVENTS_MAGIC;
+    ev_info->version       = SIMPLE_EVENTS_VERSION;
+    ev_info->nrings        = nr_cpu_ids;
+    ev_info->nslots        = nslots;
+    ev_info->event_size    = sizeof(struct simple_event);
+    ev_info->events_offset = EV_RING_HDR_BYTES;
+    ev_info->ring_offset   = PAGE_SIZE;
+    ev_info->ring_stride   = stride;
+    ev_info->map_size      = ev_buf_size;
+    for_each_possible_cpu(cpu)
+        ev_ring(cpu)->cpu = cpu;
+
+    init_irq_work(&ev_irq_work, ev_wake);
+
+    for_each_kernel_tracepoint(ev_find_tp, NULL);
+    for (i = 0; i < ARRAY_SIZE(ev_probes); i++) {
+        if (!ev_probes[i].tp) {
+            pr_err("simple: tracepoint %s not found\n", ev_probes[i].name);
+            ret = -ENOENT;
+            goto fail;
+        }
+        ret = tracepoint_probe_register(ev_probes[i].tp, ev_probes[i].probe, NULL);
+        if (ret)
+            goto fail;
+        ev_probes[i].registered = true;
+    }
+
+    ret = misc_register(&ev_dev);
+    if (ret)
+        goto fail;
+    pr_info("simple: /dev/%s, %u rings of %u events\n", SIMPLE_EVENTS_DEV, nr_cpu_ids, nslots);
+    return 0;
+
+fail:
+    events_unregister_probes();
+    vfree(ev_buf);
+    ev_buf = NULL;
+    return ret;
+}
+
+static void events_exit(void)
+{
+    misc_deregister(&ev_dev);
+    events_unregister_probes();
+    vfree(ev_buf);
+}
+
+/* ---------- Per-thread scheduling sampler ---------- */
+
+static int target_tgid;
+static unsigned int sample_ms = 1000;
+
+struct thr_sample {
+    pid_t tid;
+    u32 cpu;                /* task_cpu(): where it last ran */
+    u64 runtime_ns;         /* se.sum_exec_runtime */
+    u64 run_delay_ns;       /* sched_info.run_delay: time runnable but waiting */
+    u64 nvcsw, nivcsw;
+    char comm[TASK_COMM_LEN];
+};
+
+/* The last two samples, each sorted by tid. Protected by thr_lock. */
+struct thr_set {
+    struct thr_sample *v;
+    size_t n;
+    u64 taken_ns;
+    bool truncated;         /* more threads appeared than were allocated for */
+};
+
+static DEFINE_MUTEX(thr_lock);
+static struct thr_set thr_prev, thr_cur;
+static pid_t thr_tgid;      /* tgid the two sets belong to */
+static pid_t thr_gone;      /* target found to have exited; sampling stopped */
+static struct delayed_work thr_work;
+static bool thr_ready;      /* thr_work initialized; parameters may be set before that */
+
+static int thr_cmp(const void *a, const void *b)
+{
+    pid_t x = ((const struct thr_sample *)a)->tid, y = ((const struct thr_sample *)b)->tid;
+
+    return (x > y) - (x < y);
+}
+
+static void thr_fill(struct thr_sample *s, struct task_struct *t)
+{
+    s->tid        = t->pid;
+    s->cpu        = task_cpu(t);
+    s->runtime_ns = READ_ONCE(t->se.sum_exec_runtime);
+#ifdef CONFIG_SCHED_INFO
+    s->run_delay_ns = READ_ONCE(t->sched_info.run_delay);
+#else
+    s->run_delay_ns = 0;
+#endif
+    s->nvcsw      = READ_ONCE(t->nvcsw);
+    s->nivcsw     = READ_ONCE(t->nivcsw);
+    memcpy(s->comm, t->comm, sizeof(s->comm));
+    s->comm[sizeof(s->comm) - 1] = '\0';
+}
+
+/* Same shape as take_snapshot(): size under RCU, allocate, fill under RCU.
+ * Returns -ESRCH if the process is gone (or has no threads left to sample).
+ */
+static int thr_take(pid_t tgid, struct thr_set *set)
+{
+    struct task_struct *leader, *t;
+    size_t cap = 0, n = 0;
+
+    memset(set, 0, sizeof(*set));
+    rcu_read_lock();
+    leader = pid_task(find_pid_ns(tgid, &init_pid_ns), PIDTYPE_PID);
+    if (leader)
+        cap = READ_ONCE(leader->signal->nr_threads);
+    rcu_read_unlock();
+    if (!leader)
+        return -ESRCH;
+
+    cap += cap / 8 + 8;
+    set->v = kvmalloc_array(cap, sizeof(*set->v), GFP_KERNEL);
+    if (!set->v)
+        return -ENOMEM;
+
+    rcu_read_lock();
+    leader = pid_task(find_pid_ns(tgid, &init_pid_ns), PIDTYPE_PID);
+    if (leader) {
+        for_each_thread(leader, t) {
+            if (n == cap) {
+                set->truncated = true;
+                break;
+            }
+            thr_fill(&set->v[n++], t);
+        }
+    }
+    rcu_read_unlock();
+    if (!n) {
+        kvfree(set->v);
+        set->v = NULL;
+        return -ESRCH;
+    }
+
+    set->n = n;
+    set->taken_ns = ktime_get_ns();
+    sort(set->v, n, sizeof(*set->v), thr_cmp, NULL);
+    return 0;
+}
+
+static void thr_sample_fn(struct work_struct *work)
+{
+    pid_t tgid = READ_ONCE(target_tgid);
+    struct thr_set next;
+    int ret;
+
+    if (tgid <= 0)
+        return;
+    ret = thr_take(tgid, &next);
+    if (ret == -ESRCH) {
+        /* Stop here; thr_set_tgid() re-arms the work for the next target. */
+        mutex_lock(&thr_lock);
+        if (tgid == READ_ONCE(target_tgid)) {
+            kvfree(thr_prev.v);
+            kvfree(thr_cur.v);
+            memset(&thr_prev, 0, sizeof(thr_prev));
+            memset(&thr_cur, 0, sizeof(thr_cur));
+            thr_tgid = 0;
+            thr_gone = tgid;
+        }
+        mutex_unlock(&thr_lock);
+        return;
+    }
+    if (ret)
+        goto resched;
+
+    mutex_lock(&thr_lock);
+    thr_gone = 0;
+    kvfree(thr_prev.v);
+    if (tgid == thr_tgid) {
+        thr_prev = thr_cur;
+    } else {                /* new target: nothing to diff against yet */
+        memset(&thr_prev, 0, sizeof(thr_prev));
+        kvfree(thr_cur.v);
+        thr_tgid = tgid;
+    }
+    thr_cur = next;
+    mutex_unlock(&thr_lock);
+
+resched:
+    schedule_delayed_work(&thr_work, msecs_to_jiffies(max(sample_ms, 10u)));
+}
+
+static int thr_set_tgid(const char *val, const struct kernel_param *kp)
+{
+    int ret = param_set_int(val, kp);
+
+    if (ret)
+        return ret;
+    mutex_lock(&thr_lock);
+    thr_gone = 0;
+    mutex_unlock(&thr_lock);
+    if (READ_ONCE(thr_ready))
+        mod_delayed_work(system_wq, &thr_work, 0);   /* sample now, then every sample_ms */
+    return 0;
+}
+
+static const struct kernel_param_ops thr_tgid_ops = {
+    .set = thr_set_tgid,
+    .get = param_get_int,
+};
+
+module_param_cb(target_tgid, &thr_tgid_ops, &target_tgid, 0644);
+MODULE_PARM_DESC(target_tgid, "process whose threads are sampled (0 = off)");
+module_param(sample_ms, uint, 0644);
+MODULE_PARM_DESC(sample_ms, "sampling period in ms (default 1000, minimum 10)");
+
+static int threads_show(struct seq_file *m, void *v)
+{
+    const struct thr_set *p = &thr_prev, *c = &thr_cur;
+    u64 interval;
+    size_t i;
+
+    mutex_lock(&thr_lock);
+    if (thr_gone) {
+        seq_printf(m, "tgid %d has exited; sampling stopped (write a new target_tgid)\n", thr_gone);
+        goto out;
+    }
+    if (!c->v || !p->v) {
+        seq_printf(m, "tgid %d: waiting for two samples (set target_tgid)\n", READ_ONCE(target_tgid));
+        goto out;
+    }
+    interval = c->taken_ns - p->taken_ns;
+    seq_printf(m, "tgid %d, %zu threads, interval %llu ms%s\n", thr_tgid, c->n,
+               interval / NSEC_PER_MSEC, c->truncated ? " (thread list truncated)" : "");
+    seq_puts(m, "tid comm cpu run_us wait_us run_pct nvcsw nivcsw\n");
+
+    for (i = 0; i < c->n; i++) {
+        const struct thr_sample *s = &c->v[i];
+        const struct thr_sample *o = bsearch(s, p->v, p->n, sizeof(*s), thr_cmp);
+        struct thr_sample zero = { 0 };
+        u64 run, wait;
+
+        if (!o)
+            o = &zero;      /* started during the interval */
+        run  = s->runtime_ns - o->runtime_ns;
+        wait = s->run_delay_ns - o->run_delay_ns;
+        seq_printf(m, "%d %s %u %llu %llu %llu %llu %llu\n",
+                   s->tid, s->comm, s->cpu, run / NSEC_PER_USEC, wait / NSEC_PER_USEC,
+                   interval ? div64_u64(run * 100, interval) : 0,
+                   s->nvcsw - o->nvcsw, s->nivcsw - o->nivcsw);
+    }
+out:
+    mutex_unlock(&thr_lock);
+    return 0;
+}
+
+static int threads_open(struct inode *inode, struct file *file)
+{
+    return single_open(file, threads_show, NULL);
+}
+
+#if LINUX_VERSION_CODE >= KERNEL_VERSION(5,6,0)
+static const struct proc_ops threads_fops = {
+    .proc_open    = threads_open,
+    .proc_read    = seq_read,
+    .proc_lseek   = seq_lseek,
+    .proc_release = single_release,
+};
+#else
+static const struct file_operations threads_fops = {
+    .owner   = THIS_MODULE,
+    .open    = threads_open,
+    .read    = seq_read,
+    .llseek  = seq_lseek,
+    .release = single_release,
+};
+#endif
+
+static int threads_init(void)
+{
+    INIT_DELAYED_WORK(&thr_work, thr_sample_fn);
+    if (!proc_create(SIMPLE_THREADS_PROC, 0444, NULL, &threads_fops))
+        return -ENOMEM;
+    WRITE_ONCE(thr_ready, true);
+    if (READ_ONCE(target_tgid) > 0)         /* given at insmod time */
+        schedule_delayed_work(&thr_work, 0);
+    return 0;
+}
+
+static void threads_exit(void)
+{
+    WRITE_ONCE(thr_ready, false);
+    WRITE_ONCE(target_tgid, 0);             /* the work stops rescheduling itself */
+    cancel_delayed_work_sync(&thr_work);
+    remove_proc_entry(SIMPLE_THREADS_PROC, NULL);
+    kvfree(thr_prev.v);
+    kvfree(thr_cur.v);
+}
+
+/* ---------- Module init/exit ---------- */
+
 static int __init simple_init(void)
 {
     const struct task_struct *t = &init_task;  // PID 0 swapper/idle
+    int ret;
 
     printk("Loading Module\n");
     printk("init_task pid:%d\n", t->pid);
@@ -36,11 +780,36 @@ static int __init simple_init(void)
     pr_info("init_task process policy:%u\n", t->policy);
     pr_info("init_task tgid:%d\n", t->tgid);
 
+    if (!proc_create(SIMPLE_TASKS_PROC, 0444, NULL, &tasks_fops))
+        return -ENOMEM;
+    if (!proc_create(SIMPLE_TASKS_BIN_PROC, 0444, NULL, &tasks_bin_fops)) {
+        ret = -ENOMEM;
+        goto fail_bin;
+    }
+    ret = events_init();
+    if (ret)
+        goto fail_events;
+    ret = threads_init();
+    if (ret)
+        goto fail_threads;
+
     return 0;
+
+fail_threads:
+    events_exit();
+fail_events:
+    remove_proc_entry(SIMPLE_TASKS_BIN_PROC, NULL);
+fail_bin:
+    remove_proc_entry(SIMPLE_TASKS_PROC, NULL);
+    return ret;
 }
 
 static void __exit simple_exit(void)
 {
+    threads_exit();
+    events_exit();
+    remove_proc_entry(SIMPLE_TASKS_BIN_PROC, NULL);
+    remove_proc_entry(SIMPLE_TASKS_PROC, NULL);
     pr_info("Removing Module\n");
 }
 
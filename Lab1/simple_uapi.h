@@ -0,0 +1,102 @@
+/* simple_uapi.h — layouts shared by the simple module and its user-space tools.
+ * Included from both sides, so it only uses <linux/types.h> fixed-size types.
+ */
+#ifndef SIMPLE_UAPI_H
+#define SIMPLE_UAPI_H
+
+#include <linux/types.h>
+
+/* ---------- /proc/simple_tasks.bin ---------- */
+
+#define SIMPLE_TASKS_PROC      "simple_tasks"       /* text, one line per task */
+#define SIMPLE_TASKS_BIN_PROC  "simple_tasks.bin"   /* header + records */
+#define SIMPLE_THREADS_PROC    "simple_threads"     /* per-thread deltas of target_tgid */
+
+#define SIMPLE_TASKS_MAGIC     0x53544b53u          /* "STKS" */
+#define SIMPLE_TASKS_VERSION   1
+
+/* The binary file is one simple_tasks_hdr followed by `count` records of
+ * `rec_size` bytes each. Readers should step by rec_size so later versions can
+ * append fields. The snapshot is taken when the file is opened; every read of
+ * that open file sees the same snapshot.
+ */
+struct simple_tasks_hdr {
+    __u32 magic;
+    __u32 version;
+    __u32 rec_size;
+    __u32 count;
+    __u64 taken_ns;     /* ktime_get_ns() when the snapshot was taken */
+};
+
+struct simple_task_rec {
+    __s32 pid;
+    __s32 tgid;
+    __u32 state;        /* __state, or'ed with exit_state (EXIT_ZOMBIE/EXIT_DEAD) */
+    __u32 policy;
+    __u32 rt_priority;
+    __u32 flags;        /* PF_* */
+    __u64 utime_ns;
+    __u64 stime_ns;
+    __u64 nvcsw;
+    __u64 nivcsw;
+};
+
+/* ---------- /dev/simple_events ---------- */
+
+#define SIMPLE_EVENTS_DEV      "simple_events"
+#define SIMPLE_EVENTS_MAGIC    0x53455654u          /* "SEVT" */
+#define SIMPLE_EVENTS_VERSION  2          /* 2: info page read-only, rings mapped separately */
+
+enum simple_event_type {
+    SIMPLE_EV_FORK = 1,
+    SIMPLE_EV_EXEC = 2,
+    SIMPLE_EV_EXIT = 3,
+};
+
+/* One fixed-size record per sched_process_{fork,exec,exit} hit. */
+struct simple_event {
+    __u64 ts_ns;        /* ktime_get_ns() */
+    __u32 type;         /* enum simple_event_type */
+    __u32 cpu;
+    __s32 pid;          /* fork: the child */
+    __s32 tgid;
+    __s32 aux;          /* fork: parent pid; exec: pid before exec; exit: exit_code */
+    __u32 reserved;
+    char  comm[16];
+};
+
+/* The first page of the device holds simple_events_info and can only be
+ * mapped read-only. Ring i (one per possible CPU) starts at device offset
+ * ring_offset + i * ring_stride with a simple_ring_hdr, followed by nslots
+ * events at events_offset within the ring. ring_offset is page aligned, so
+ * the rings are mapped read-write with a second mmap at that offset.
+ *
+ * Each ring has one producer (the kernel, on that CPU) and one consumer (the
+ * process that opened the device). head and tail count events since load and
+ * never wrap; the slot is index & (nslots - 1). The consumer reads head with
+ * acquire semantics, consumes slots [tail, head), then publishes tail with
+ * release semantics. A full ring drops new events and counts them.
+ */
+struct simple_events_info {
+    __u32 magic;
+    __u32 version;
+    __u32 nrings;
+    __u32 nslots;       /* power of two */
+    __u32 event_size;
+    __u32 events_offset;
+    __u64 ring_offset;
+    __u64 ring_stride;
+    __u64 map_size;     /* bytes to mmap */
+};
+
+struct simple_ring_hdr {
+    __u64 head;         /* written by the kernel */
+    __u64 pad0[7];
+    __u64 tail;         /* written by the consumer */
+    __u64 pad1[7];
+    __u64 dropped;      /* written by the kernel */
+    __u32 cpu;
+    __u32 reserved;
+};
+
+#endif /* SIMPLE_UAPI_H */
@@ -0,0 +1,138 @@
+// tasksnap.c — read /proc/simple_tasks.bin (from simple.ko) and summarize it.
+// Build:   gcc -Wall -Wextra -std=c11 -O2 -o tasksnap tasksnap.c
+// Run:     sudo insmod simple.ko && ./tasksnap          # summary + 10 busiest tasks
+//          ./tasksnap -t 0 -l                           # list every task
+//          ./tasksnap -r 100                            # time 100 snapshots
+//
+// Flags:
+//   -f <path>    snapshot file (default /proc/simple_tasks.bin)
+//   -t <int>     show the N tasks with the most utime+stime (default 10)
+//   -l           list every record
+//   -r <int>     take N snapshots and report the average time per snapshot
+
+#define _POSIX_C_SOURCE 200809L
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "simple_uapi.h"
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+// Read the whole file; /proc files report size 0, so grow until EOF.
+// Returns the byte count, or -1 with errno set.
+static ssize_t read_all(const char* path, char** buf, size_t* cap) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return -1;
+    size_t len = 0;
+    for (;;) {
+        if (len == *cap) {
+            size_t ncap = *cap ? *cap * 2 : (size_t)1 << 20;
+            char* n = realloc(*buf, ncap);
+            if (!n) { close(fd); errno = ENOMEM; return -1; }
+            *buf = n;
+            *cap = ncap;
+        }
+        ssize_t r = read(fd, *buf + len, *cap - len);
+        if (r < 0) {
+            if (errno == EINTR) continue;
+            int e = errno;
+            close(fd);
+            errno = e;
+            return -1;
+        }
+        if (r == 0) break;
+        len += (size_t)r;
+    }
+    close(fd);
+    return (ssize_t)len;
+}
+
+static const struct simple_task_rec* rec_at(const char* buf, const struct simple_tasks_hdr* h, size_t i) {
+    return (const struct simple_task_rec*)(buf + sizeof(*h) + i * h->rec_size);
+}
+
+static int by_cpu_desc(const void* a, const void* b) {
+    const struct simple_task_rec* x = *(const struct simple_task_rec* const*)a;
+    const struct simple_task_rec* y = *(const struct simple_task_rec* const*)b;
+    unsigned long long tx = x->utime_ns + x->stime_ns, ty = y->utime_ns + y->stime_ns;
+    return (tx < ty) - (tx > ty);
+}
+
+static void print_rec(const struct simple_task_rec* r) {
+    printf("%8d %8d %6u %6u %4u %#10x %12.3f %12.3f %10llu %10llu\n",
+           r->pid, r->tgid, r->state, r->policy, r->rt_priority, r->flags,
+           (double)r->utime_ns / 1e9, (double)r->stime_ns / 1e9,
+           (unsigned long long)r->nvcsw, (unsigned long long)r->nivcsw);
+}
+
+int main(int argc, char** argv) {
+    const char* path = "/proc/" SIMPLE_TASKS_BIN_PROC;
+    int top = 10, list = 0, reps = 1;
+
+    int c;
+    while ((c = getopt(argc, argv, "f:t:lr:h")) != -1) {
+        switch (c) {
+            case 'f': path = optarg; break;
+            case 't': top = atoi(optarg); break;
+            case 'l': list = 1; break;
+            case 'r': reps = atoi(optarg); break;
+            default:
+                fprintf(stderr, "Usage: %s [-f file] [-t top] [-l] [-r reps]\n", argv[0]);
+                return c == 'h' ? 0 : EXIT_FAILURE;
+        }
+    }
+    if (reps < 1) reps = 1;
+
+    char* buf = NULL;
+    size_t cap = 0;
+    ssize_t len = -1;
+    double t0 = now_sec();
+    for (int r = 0; r < reps; ++r) {
+        len = read_all(path, &buf, &cap);
+        if (len < 0) { perror(path); return EXIT_FAILURE; }
+    }
+    double per_snap = (now_sec() - t0) / reps;
+
+    const struct simple_tasks_hdr* h = (const struct simple_tasks_hdr*)buf;
+    if ((size_t)len < sizeof(*h) || h->magic != SIMPLE_TASKS_MAGIC ||
+        h->rec_size < sizeof(struct simple_task_rec) ||
+        sizeof(*h) + (size_t)h->count * h->rec_size > (size_t)len) {
+        fprintf(stderr, "%s: not a task snapshot (or truncated)\n", path);
+        return EXIT_FAILURE;
+    }
+
+    size_t procs = 0, running = 0;
+    for (size_t i = 0; i < h->count; ++i) {
+        const struct simple_task_rec* r = rec_at(buf, h, i);
+        if (r->pid == r->tgid) procs++;
+        if (r->state == 0) running++;
+    }
+    printf("%u tasks in %zu processes, %zu running; %zd bytes, %.3f ms per snapshot\n",
+           h->count, procs, running, len, per_snap * 1e3);
+
+    const char* header = "     pid     tgid  state policy  rtp      flags      utime s      stime s      nvcsw     nivcsw\n";
+    if (list) {
+        printf("%s", header);
+        for (size_t i = 0; i < h->count; ++i) print_rec(rec_at(buf, h, i));
+    } else if (top > 0 && h->count > 0) {
+        const struct simple_task_rec** order = malloc(sizeof(*order) * h->count);
+        if (!order) { perror("malloc"); return EXIT_FAILURE; }
+        for (size_t i = 0; i < h->count; ++i) order[i] = rec_at(buf, h, i);
+        qsort(order, h->count, sizeof(*order), by_cpu_desc);
+        printf("%s", header);
+        for (size_t i = 0; i < h->count && i < (size_t)top; ++i) print_rec(order[i]);
+        free(order);
+    }
+
+    free(buf);
+    return 0;
+}
@@ -1,100 +1,271 @@
 // PLfork.c
 // Lab 2 – Part I: fork()/wait() process tree (9 total processes), print each PID exactly once.
-// Build:   gcc -Wall -Wextra -std=c11 -o PLfork PLfork.c
-// Run:     ./PLfork
+// Build:   gcc -Wall -Wextra -std=c11 -O2 -pthread -I../common -o PLfork PLfork.c proctree.c ../common/perfctr.c
+// Run:     ./PLfork                              # the lab tree below
+//          ./PLfork -s 3,2                       # root with 3 children, each with 2 children
+//          ./PLfork -s "((())((())())())"        # any shape, one "(...)" per process
+//          ./PLfork -s 10,10,10 -q               # 1111 processes, timing only
+//          ./PLfork -s 10,10,10 -c > report.txt  # one table row per process, written once by the root
+//          ./PLfork -B -W 2,4,8,16 -D 6 -m 5000  # sweep depth x width, print a timing table
 //
-// Tree used (1 parent + 8 descendants = 9 total):
+// Flags:
+//   -s <spec>    tree spec: a fanout list ("3,2") or a parenthesized tree
+//   -q           quiet: don't print PIDs, only the timing line
+//   -c           collect: every process records its PID, parent, depth and start/end
+//                times in a shared-memory table row reserved for its tree position,
+//                and the root prints the whole table with a single write()
+//   -P           report CPU time, context switches, page faults (and cycles,
+//                instructions, cache misses where there is a PMU) spent building
+//                the tree, children included, on stderr (perfctr.c)
+//   -B           benchmark: for every width in -W and depth 1..-D build a full tree
+//                (skipping trees with more than -m processes) and report the times
+//   -W <list>    widths for -B (default 2,4,8)
+//   -D <int>     maximum depth for -B (default 4)
+//   -m <int>     maximum processes per tree for -B (default 2000)
+//
+// Tree used by default (1 parent + 8 descendants = 9 total):
 //          P
 //      /   |    \
 //     A    B     C
 //    / \   |    / \
 //   D   E  F   G   H
+// which is the spec "((()())(())(()()))".
 //
-// Each parent waits for its own children. Every process prints exactly its own PID once.
+// Each process forks all of its children before waiting for any of them, so
+// siblings are created concurrently. Each parent then waits for its own
+// children and prints its own PID once, after its children (P prints last).
+// With -c nothing is printed per process; the table is filled in instead.
 
 #define _POSIX_C_SOURCE 200809L
+#define _DEFAULT_SOURCE   // MAP_ANONYMOUS
+#include <stdarg.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <time.h>
 #include <unistd.h>
-#include <sys/wait.h>
+#include <sys/mman.h>
+#include <sys/types.h>
+
+#include "perfctr.h"
+#include "proctree.h"
+
+static const char* LAB_TREE = "((()())(())(()()))";
+
+// Shared with every process in the tree (MAP_SHARED anonymous mapping).
+typedef struct {
+    int started;              // processes that have begun running (atomic)
+    long long all_started_ns; // when the last one began
+} tree_clock;
+
+// One row per tree position, on its own cache line so processes don't contend.
+typedef struct {
+    _Alignas(64) pid_t pid;
+    pid_t ppid;
+    int depth;
+    long long start_ns, end_ns;
+} proc_row;
 
-static pid_t fork_or_die(void) {
-    pid_t p = fork();
-    if (p < 0) { perror("fork"); exit(EXIT_FAILURE); }
-    return p;
+typedef struct {
+    tree_clock* clock;
+    proc_row* rows;           // NULL unless collecting (-c)
+    int total;
+    int quiet;
+} run_ctx;
+
+static long long now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000000000LL + ts.tv_nsec;
 }
 
-static void wait_all_children(void) {
-    int status;
-    while (1) {
-        pid_t w = wait(&status);
-        if (w == -1) break; // no more children
+static void on_start(const proctree* t, int node, void* varg) {
+    run_ctx* ctx = (run_ctx*)varg;
+    if (ctx->rows) {
+        proc_row* r = &ctx->rows[node];
+        r->pid = getpid();
+        r->ppid = getppid();
+        r->depth = t->nodes[node].depth;
+        r->start_ns = now_ns();
+    }
+    if (__atomic_add_fetch(&ctx->clock->started, 1, __ATOMIC_ACQ_REL) == ctx->total) {
+        ctx->clock->all_started_ns = now_ns();
     }
 }
 
-int main(void) {
-    // P prints its PID after creating the tree to avoid duplicates/out-of-order printing
-    pid_t a,b,c;
-
-    // Create A
-    a = fork_or_die();
-    if (a == 0) {
-        // We're A
-        pid_t d = fork_or_die();
-        if (d == 0) {
-            // D
-            printf("%d\n", getpid());
-            _exit(0);
-        }
-        pid_t e = fork_or_die();
-        if (e == 0) {
-            // E
-            printf("%d\n", getpid());
-            _exit(0);
-        }
-        wait_all_children();
-        printf("%d\n", getpid()); // A
-        _exit(0);
+static void on_done(const proctree* t, int node, void* varg) {
+    (void)t;
+    run_ctx* ctx = (run_ctx*)varg;
+    if (ctx->rows) {
+        ctx->rows[node].end_ns = now_ns();
+    } else if (!ctx->quiet) {
+        printf("%d\n", getpid());
+        fflush(stdout); // the process _exits right after this
+    }
+}
+
+// Append to buf[0..*len), growing it when a line does not fit.
+// Returns 0, or -1 if formatting or the allocation failed.
+static int buf_printf(char** buf, size_t* cap, size_t* len, const char* fmt, ...) {
+    for (;;) {
+        va_list ap;
+        va_start(ap, fmt);
+        int n = vsnprintf(*buf + *len, *cap - *len, fmt, ap);
+        va_end(ap);
+        if (n < 0) return -1;
+        if ((size_t)n < *cap - *len) { *len += (size_t)n; return 0; }
+
+        size_t ncap = *cap * 2;
+        while (ncap - *len <= (size_t)n) ncap *= 2;
+        char* p = realloc(*buf, ncap);
+        if (!p) return -1;
+        *buf = p;
+        *cap = ncap;
     }
+}
 
-    // Create B
-    b = fork_or_die();
-    if (b == 0) {
-        // We're B
-        pid_t f = fork_or_die();
-        if (f == 0) {
-            // F
-            printf("%d\n", getpid());
-            _exit(0);
-        }
-        wait_all_children();
-        printf("%d\n", getpid()); // B
-        _exit(0);
+// Format the whole table into one buffer and emit it with a single write().
+// Rows are in tree-position order; times are relative to the root's start.
+static void write_report(const proctree* t, const proc_row* rows) {
+    size_t cap = 96 + (size_t)t->count * 80, len = 0;   // typical row size; grown if exceeded
+    char* buf = malloc(cap);
+    if (!buf) { perror("malloc"); return; }
+
+    int rc = buf_printf(&buf, &cap, &len, "%7s %7s %5s %8s %8s %12s %12s\n",
+                        "node", "parent", "depth", "pid", "ppid", "start_us", "end_us");
+    long long base = rows[0].start_ns;
+    for (int i = 0; i < t->count && rc == 0; ++i) {
+        const proc_row* r = &rows[i];
+        rc = buf_printf(&buf, &cap, &len, "%7d %7d %5d %8d %8d %12.1f %12.1f\n",
+                        i, t->nodes[i].parent, r->depth, (int)r->pid, (int)r->ppid,
+                        r->pid ? (double)(r->start_ns - base) / 1e3 : -1.0,
+                        r->pid ? (double)(r->end_ns - base) / 1e3 : -1.0);
+    }
+    if (rc != 0) perror("write_report");   // print what fit so far
+
+    for (size_t off = 0; off < len;) {
+        ssize_t w = write(STDOUT_FILENO, buf + off, len - off);
+        if (w < 0) { perror("write"); break; }
+        off += (size_t)w;
+    }
+    free(buf);
+}
+
+// Build the tree once; returns failures and fills in the two times (ms).
+// With collect set, prints the per-process table afterwards.
+static int run_tree(const proctree* t, int quiet, int collect, double* build_ms, double* total_ms) {
+    tree_clock* clock = mmap(NULL, sizeof(tree_clock), PROT_READ | PROT_WRITE,
+                             MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (clock == MAP_FAILED) { perror("mmap"); exit(EXIT_FAILURE); }
+    memset(clock, 0, sizeof(*clock));
+
+    // Rows are zero-filled by mmap, so a process that never ran shows pid 0.
+    size_t rows_len = sizeof(proc_row) * (size_t)t->count;
+    proc_row* rows = NULL;
+    if (collect) {
+        rows = mmap(NULL, rows_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+        if (rows == MAP_FAILED) { perror("mmap"); exit(EXIT_FAILURE); }
+    }
+
+    run_ctx ctx = { clock, rows, t->count, quiet };
+    proctree_hooks hooks = { on_start, on_done, &ctx };
+
+    static int region = -1;
+    if (region < 0) region = perfctr_region("tree");
+
+    long long t0 = now_ns();
+    perfctr_start(region);
+    int failed = proctree_build(t, &hooks);
+    perfctr_stop(region);
+    long long t1 = now_ns();
+
+    *build_ms = clock->all_started_ns ? (double)(clock->all_started_ns - t0) / 1e6 : -1.0;
+    *total_ms = (double)(t1 - t0) / 1e6;
+    if (rows) {
+        write_report(t, rows);
+        munmap(rows, rows_len);
     }
+    munmap(clock, sizeof(tree_clock));
+    return failed;
+}
+
+static int benchmark(const char* widths, int max_depth, int max_nodes) {
+    printf("%6s %6s %10s %12s %12s %12s\n", "width", "depth", "processes", "created ms", "reaped ms", "us/process");
+    int failures = 0;
+    for (const char* w = widths; *w;) {
+        int width = atoi(w);
+        for (int depth = 1; depth <= max_depth && width > 0; ++depth) {
+            // Fanout spec "width,width,...,width" with `depth` levels.
+            long long nodes = 1, level = 1;
+            for (int d = 0; d < depth; ++d) { level *= width; nodes += level; }
+            if (nodes > max_nodes) break;
+
+            char spec[512] = "";
+            for (int d = 0; d < depth; ++d) {
+                size_t len = strlen(spec);
+                snprintf(spec + len, sizeof(spec) - len, d ? ",%d" : "%d", width);
+            }
+            proctree t;
+            if (proctree_parse(spec, &t) != 0) return 1;
 
-    // Create C
-    c = fork_or_die();
-    if (c == 0) {
-        // We're C
-        pid_t g = fork_or_die();
-        if (g == 0) {
-            // G
-            printf("%d\n", getpid());
-            _exit(0);
+            double build_ms, total_ms;
+            int failed = run_tree(&t, 1, 0, &build_ms, &total_ms);
+            printf("%6d %6d %10d %12.2f %12.2f %12.2f%s\n", width, depth, t.count,
+                   build_ms, total_ms, total_ms * 1e3 / t.count, failed ? "  (failures)" : "");
+            failures += failed;
+            proctree_free(&t);
         }
-        pid_t h = fork_or_die();
-        if (h == 0) {
-            // H
-            printf("%d\n", getpid());
-            _exit(0);
+        w = strchr(w, ',');
+        if (!w) break;
+        ++w;
+    }
+    return failures;
+}
+
+int main(int argc, char** argv) {
+    const char* spec = LAB_TREE;
+    const char* widths = "2,4,8";
+    int quiet = 0, collect = 0, perf = 0, bench = 0, max_depth = 4, max_nodes = 2000;
+
+    int c;
+    while ((c = getopt(argc, argv, "s:qcPBW:D:m:h")) != -1) {
+        switch (c) {
+            case 's': spec = optarg; break;
+            case 'q': quiet = 1; break;
+            case 'c': collect = 1; break;
+            case 'P': perf = 1; break;
+            case 'B': bench = 1; break;
+            case 'W': widths = optarg; break;
+            case 'D': max_depth = atoi(optarg); break;
+            case 'm': max_nodes = atoi(optarg); break;
+            default:
+                fprintf(stderr, "Usage: %s [-s spec] [-q] [-c] [-P] | -B [-W widths] [-D depth] [-m max_procs]\n", argv[0]);
+                return c == 'h' ? 0 : EXIT_FAILURE;
         }
-        wait_all_children();
-        printf("%d\n", getpid()); // C
-        _exit(0);
     }
 
-    // Parent P waits for A, B, C (and by extension all grandchildren)
-    wait_all_children();
-    printf("%d\n", getpid()); // P (printed last)
-    return 0;
+    // Inherited counters: every process of the tree is counted once it is reaped.
+    if (perf) perfctr_init(PERFCTR_INHERIT);
+
+    if (bench) {
+        int failures = benchmark(widths, max_depth, max_nodes);
+        perfctr_report(stderr);
+        return failures ? EXIT_FAILURE : 0;
+    }
+
+    proctree t;
+    if (proctree_parse(spec, &t) != 0) return EXIT_FAILURE;
+
+    double build_ms, total_ms;
+    int failed = run_tree(&t, quiet, collect, &build_ms, &total_ms);
+    if (quiet || collect) {
+        // With -c stdout carries only the table, so the timing line goes to stderr.
+        fprintf(collect ? stderr : stdout, "%d processes, depth %d: all created after %.2f ms, all reaped after %.2f ms\n",
+                t.count, t.max_depth, build_ms, total_ms);
+    }
+    if (failed) fprintf(stderr, "%d subtree(s) failed\n", failed);
+    perfctr_report(stderr);
+
+    proctree_free(&t);
+    return failed ? EXIT_FAILURE : 0;
 }
@@ -0,0 +1,160 @@
+// PLprocsum.c
+// Parallel sum with worker *processes*: fork() N children over a MAP_SHARED
+// input mapping, each child writes its partial sum into its own padded slot of
+// a shared anonymous mapping, and the parent reaps them all before adding up.
+// A crashing worker only loses its own slice; the parent notices it from the
+// exit status and reports the slot as missing instead of going down with it.
+//
+// Build:   gcc -Wall -Wextra -std=c11 -O2 -pthread -o PLprocsum PLprocsum.c proctree.c reduce.c sum_simd.c input.c wspool.c -lm
+// Run:     ./PLprocsum                       # 100M generated ints, one process per core
+//          ./PLprocsum -p 8 -r 20            # 8 processes, best of 20 runs
+//          ./PLprocsum -f data.bin           # mmap a binary file of 32-bit ints
+//
+// Flags:
+//   -n <count>   number of generated ints (default 100000000)
+//   -f <file>    sum a binary file of native-endian 32-bit ints instead
+//   -p <int>     number of worker processes/threads (default: online core count)
+//   -r <int>     repetitions; the best time of each engine is reported (default 5)
+//
+// For comparison the same data is also summed by threads created per call
+// (reduce.c) and by the persistent thread pool (wspool.c).
+
+#define _POSIX_C_SOURCE 200809L
+#define _DEFAULT_SOURCE   // MAP_ANONYMOUS
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#include "input.h"
+#include "proctree.h"
+#include "reduce.h"
+#include "sum_simd.h"
+#include "wspool.h"
+
+#define CACHE_LINE 64
+
+// One per worker process, each on its own cache line.
+typedef struct {
+    _Alignas(CACHE_LINE) long long sum;
+    int done;       // set by the child after sum is written
+} slot;
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+// One process-based reduction. Returns the number of workers that failed.
+static int proc_sum(const int* data, size_t n, int nprocs, slot* slots, long long* out) {
+    for (int i = 0; i < nprocs; ++i) slots[i].done = 0;
+
+    int launched = 0;
+    for (int i = 0; i < nprocs; ++i, ++launched) {
+        pid_t p = proc_fork();
+        if (p < 0) break;   // still reap the workers already running below
+        if (p == 0) {
+            size_t from = (size_t)((unsigned __int128)n * (unsigned)i / (unsigned)nprocs);
+            size_t to   = (size_t)((unsigned __int128)n * (unsigned)(i + 1) / (unsigned)nprocs);
+            slots[i].sum = sum_i32(data + from, to - from);
+            __atomic_store_n(&slots[i].done, 1, __ATOMIC_RELEASE);
+            _exit(0);
+        }
+    }
+    // Workers that were never started count as failed; their slots stay empty.
+    int failed = proc_wait_all() + (nprocs - launched);
+
+    long long total = 0;
+    for (int i = 0; i < nprocs; ++i) {
+        if (__atomic_load_n(&slots[i].done, __ATOMIC_ACQUIRE)) total += slots[i].sum;
+        else fprintf(stderr, "worker %d produced no result\n", i);
+    }
+    *out = total;
+    return failed;
+}
+
+int main(int argc, char** argv) {
+    size_t count = 100000000;
+    const char* path = NULL;
+    int nprocs = 0, reps = 5;
+
+    int c;
+    while ((c = getopt(argc, argv, "n:f:p:r:h")) != -1) {
+        switch (c) {
+            case 'n': count = strtoull(optarg, NULL, 10); break;
+            case 'f': path = optarg; break;
+            case 'p': nprocs = atoi(optarg); break;
+            case 'r': reps = atoi(optarg); break;
+            default:
+                fprintf(stderr, "Usage: %s [-n count | -f binfile] [-p procs] [-r reps]\n", argv[0]);
+                return c == 'h' ? 0 : EXIT_FAILURE;
+        }
+    }
+    if (!path && count == 0) {
+        fprintf(stderr, "%s: -n must be at least 1\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    if (nprocs <= 0) nprocs = reduce_default_threads();
+    if (reps < 1) reps = 1;
+
+    // Input: either a MAP_SHARED file mapping or a MAP_SHARED anonymous region,
+    // so children read the parent's pages directly with no copy-on-write setup.
+    numeric_input in;
+    int* shared_data = NULL;
+    if (path) {
+        if (input_map_binary(path, &in) != 0) { perror(path); return EXIT_FAILURE; }
+    } else {
+        shared_data = mmap(NULL, count * sizeof(int), PROT_READ | PROT_WRITE,
+                           MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+        if (shared_data == MAP_FAILED) { perror("mmap"); return EXIT_FAILURE; }
+        for (size_t i = 0; i < count; ++i) shared_data[i] = (int)(i % 1000) + 1;
+        memset(&in, 0, sizeof(in));
+        in.data = shared_data;
+        in.count = count;
+    }
+
+    slot* slots = mmap(NULL, sizeof(slot) * (size_t)nprocs, PROT_READ | PROT_WRITE,
+                       MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (slots == MAP_FAILED) { perror("mmap"); return EXIT_FAILURE; }
+
+    wspool* pool = wspool_create(nprocs);
+    if (!pool) { perror("wspool_create"); return EXIT_FAILURE; }
+    reduce_options spawn_opt = { nprocs, REDUCE_STATIC, 0, NULL };
+    reduce_options pool_opt  = { nprocs, REDUCE_STATIC, 0, pool };
+
+    const char* names[3] = { "processes", "threads", "thread pool" };
+    double best[3] = { 1e30, 1e30, 1e30 };
+    long long sums[3] = { 0, 0, 0 };
+    int failures = 0;
+
+    for (int r = 0; r < reps; ++r) {
+        double t0 = now_sec();
+        failures += proc_sum(in.data, in.count, nprocs, slots, &sums[0]);
+        double t1 = now_sec();
+        if (reduce_sum_int(in.data, in.count, &spawn_opt, &sums[1]) != 0) { perror("reduce_sum_int"); return EXIT_FAILURE; }
+        double t2 = now_sec();
+        if (reduce_sum_int(in.data, in.count, &pool_opt, &sums[2]) != 0) { perror("reduce_sum_int"); return EXIT_FAILURE; }
+        double t3 = now_sec();
+        if (t1 - t0 < best[0]) best[0] = t1 - t0;
+        if (t2 - t1 < best[1]) best[1] = t2 - t1;
+        if (t3 - t2 < best[2]) best[2] = t3 - t2;
+    }
+
+    printf("Sum of numbers in the list is: %lld\n", sums[0]);
+    printf("%zu ints, %d workers, best of %d:\n", in.count, nprocs, reps);
+    for (int e = 0; e < 3; ++e) {
+        printf("  %-12s %10.3f ms  %6.2f GB/s%s\n", names[e], best[e] * 1e3,
+               (double)(in.count * sizeof(int)) / best[e] / 1e9,
+               sums[e] == sums[2] ? "" : "  (different sum!)");
+    }
+    if (failures) fprintf(stderr, "%d worker process(es) failed\n", failures);
+
+    wspool_destroy(pool);
+    munmap(slots, sizeof(slot) * (size_t)nprocs);
+    if (shared_data) munmap(shared_data, count * sizeof(int));
+    else input_release(&in);
+    return failures ? EXIT_FAILURE : 0;
+}
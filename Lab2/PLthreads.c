@@ -1,68 +1,241 @@
 // PLthreads.c
-// Lab 2 – Part II: Sum 20 integers using two Pthreads, each summing half the array.
-// Build:   gcc -Wall -Wextra -std=c11 -pthread -o PLthreads PLthreads.c
-// Run:     ./PLthreads
+// Lab 2 – Part II: Sum a list of integers using Pthreads, each thread summing a slice.
+// Build:   gcc -Wall -Wextra -std=c11 -O2 -pthread -I../common -o PLthreads PLthreads.c reduce.c sum_simd.c input.c wspool.c stats.c ../common/perfctr.c -lm
+// Run:     ./PLthreads                        # the 20-element lab list, one thread per core
+//          ./PLthreads -t 2                   # original two-thread split
+//          ./PLthreads -n 1000000000 -t 8     # 1e9 generated ints on an 8-thread pool
+//          ./PLthreads -n 10000 -r 1000 -x    # 1000 small reductions, fresh threads each time
+//          ./PLthreads -f data.bin            # mmap a file of native-endian 32-bit ints
+//          ./PLthreads -T data.txt            # parse a whitespace-separated text file in parallel
+//          ./gen | ./PLthreads -S             # stream binary ints from stdin
 //
-// Approach: Each thread receives [from_index, to_index] via a heap-allocated struct,
-// computes a local sum, returns it via pthread_exit((void*)pointer). The parent joins
-// both threads, adds the two partial sums, prints the total, and frees memory.
+// Flags:
+//   -n <count>   sum <count> generated integers (1, 2, ..., 1000, 1, 2, ...) instead of the lab list
+//   -t <int>     number of threads (default: online core count)
+//   -r <count>   repeat the reduction <count> times and report the mean time per reduction
+//   -x           create and join fresh threads for every reduction instead of using the pool
+//   -d           with -x: dynamic partitioning (threads pull chunks from a shared cursor)
+//   -c <count>   pool split grain, or chunk size for -x -d (default 65536)
+//   -f <file>    sum a binary file of 32-bit ints, mapped with mmap (no copy)
+//   -T <file>    sum a text file of integers, parsed in parallel chunks
+//   -S           stream binary 32-bit ints from stdin; the next block is read while
+//                the current one is summed (double buffering)
+//   -B <count>   ints per streaming block for -S (default 1048576)
+//   -s           also report count, min, max, mean and variance (one fused pass, stats.c)
+//   -H lo:hi:bins  with -s: fixed-width histogram of [lo, hi) with <bins> bins (max 256)
+//   -k <kernel>  force the per-thread sum kernel: scalar, sse2, avx2 or avx512 (default: best via CPUID)
+//   -V           verify every SIMD kernel against the scalar path and the text
+//                parser on edge-case inputs, then exit
+//   -P           report cycles, instructions, cache misses, context switches, ...
+//                (perfctr.c) for loading, reducing, stats and the whole run, on stderr.
+//                Pool workers exit only when the pool is destroyed, so their
+//                counts show up under "total"; threads made per call (-x) also
+//                show up under "reduce".
+//
+// Approach: a persistent work-stealing pool (wspool.c) is created once and every
+// reduction runs on it, so repeated reductions pay no thread creation cost and
+// uneven ranges are balanced by stealing. Each worker accumulates into its own
+// padded slot, and the slots are added at the end. With -x the reduction engine
+// in reduce.c instead creates and joins threads per call. Either way each range
+// is summed by a SIMD kernel (sum_simd.c) chosen at startup from CPUID.
 
 #define _POSIX_C_SOURCE 200809L
 #include <stdio.h>
 #include <stdlib.h>
-#include <pthread.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
 
-typedef struct {
-    int from_index;
-    int to_index;
-} parameters;
+#include "input.h"
+#include "perfctr.h"
+#include "reduce.h"
+#include "stats.h"
+#include "sum_simd.h"
 
-static const int SIZE = 20;
 static int list_data[20] = {
     1,2,3,4,5,6,7,8,9,10,
     11,12,13,14,15,16,17,18,19,20
 };
 
-static void* runner(void* arg) {
-    parameters* p = (parameters*)arg;
-    long long* partial = malloc(sizeof(long long));
-    if (!partial) { perror("malloc"); pthread_exit(NULL); }
-    *partial = 0;
-    for (int i = p->from_index; i <= p->to_index; ++i) {
-        *partial += list_data[i];
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+// One fused pass over the data for everything -s asks for.
+static int print_stats(const reduce_options* opt, const numeric_input* in, stats_hist* hist) {
+    wspool* pool = opt->pool ? opt->pool : wspool_create(opt->nthreads);
+    if (!pool) { perror("wspool_create"); return -1; }
+
+    unsigned what = STATS_SUM | STATS_MINMAX | STATS_MOMENTS | (hist ? STATS_HIST : 0);
+    stats_i32_result r;
+    int rc = stats_compute(pool, in->data, in->count, what, hist, &r);
+    if (pool != opt->pool) wspool_destroy(pool);
+    if (rc != 0) { perror("stats"); return -1; }
+
+    printf("count=%zu sum=%lld min=%d max=%d mean=%.6f variance=%.6f\n",
+           r.count, r.sum, r.count ? r.min : 0, r.count ? r.max : 0,
+           r.moments.mean, stats_variance(&r.moments));
+    if (hist) {
+        double width = (hist->hi - hist->lo) / (double)hist->bins;
+        printf("below %g: %llu\n", hist->lo, (unsigned long long)hist->below);
+        for (size_t b = 0; b < hist->bins; ++b) {
+            printf("[%g, %g): %llu\n", hist->lo + width * (double)b,
+                   hist->lo + width * (double)(b + 1), (unsigned long long)hist->counts[b]);
+        }
+        printf("at or above %g: %llu\n", hist->hi, (unsigned long long)hist->above);
     }
-    free(p); // free the parameters passed on the heap
-    pthread_exit(partial); // return pointer to partial sum
+    return 0;
 }
 
-int main(void) {
-    pthread_t t1, t2;
-    pthread_attr_t attr;
-    pthread_attr_init(&attr);
+static void usage(const char* prog) {
+    fprintf(stderr, "Usage: %s [-n count] [-t threads] [-r repeat] [-x [-d]] [-c chunk]\n"
+                    "       [-f binfile | -T textfile | -S [-B block]] [-s [-H lo:hi:bins]] [-k kernel] [-V] [-P]\n", prog);
+}
 
-    // First half [0 .. SIZE/2 - 1]
-    parameters* p1 = (parameters*)malloc(sizeof(parameters));
-    if (!p1) { perror("malloc"); return EXIT_FAILURE; }
-    p1->from_index = 0;
-    p1->to_index   = (SIZE/2) - 1;
+int main(int argc, char** argv) {
+    reduce_options opt = { 0, REDUCE_STATIC, 0, NULL };
+    size_t count = 0;   // 0 = use the built-in lab list
+    int repeat = 1;
+    int spawn = 0;
+    int want_stats = 0;
+    stats_hist hist = { 0 };
+    const char* bin_path = NULL;
+    const char* text_path = NULL;
+    int stream = 0;
+    size_t block = 0;
+    int perf = 0;
 
-    // Second half [SIZE/2 .. SIZE - 1]
-    parameters* p2 = (parameters*)malloc(sizeof(parameters));
-    if (!p2) { perror("malloc"); return EXIT_FAILURE; }
-    p2->from_index = (SIZE/2);
-    p2->to_index   = SIZE - 1;
+    int c;
+    while ((c = getopt(argc, argv, "n:t:r:xdc:f:T:SB:sH:k:VPh")) != -1) {
+        switch (c) {
+            case 'n': count = strtoull(optarg, NULL, 10); break;
+            case 't': opt.nthreads = atoi(optarg); break;
+            case 'r': repeat = atoi(optarg); break;
+            case 'x': spawn = 1; break;
+            case 'd': opt.schedule = REDUCE_DYNAMIC; break;
+            case 'c': opt.chunk = strtoull(optarg, NULL, 10); break;
+            case 'f': bin_path = optarg; break;
+            case 'T': text_path = optarg; break;
+            case 'S': stream = 1; break;
+            case 'B': block = strtoull(optarg, NULL, 10); break;
+            case 's': want_stats = 1; break;
+            case 'H':
+                if (sscanf(optarg, "%lf:%lf:%zu", &hist.lo, &hist.hi, &hist.bins) != 3) {
+                    usage(argv[0]);
+                    return EXIT_FAILURE;
+                }
+                break;
+            case 'k': {
+                int lvl = SUM_SCALAR;
+                while (lvl < SUM_LEVELS && strcmp(optarg, sum_simd_name((sum_level)lvl)) != 0) ++lvl;
+                if (lvl == SUM_LEVELS) { usage(argv[0]); return EXIT_FAILURE; }
+                if ((int)sum_simd_set_level((sum_level)lvl) != lvl) {
+                    fprintf(stderr, "%s not supported on this CPU, using %s\n",
+                            optarg, sum_simd_name(sum_simd_level()));
+                }
+                break;
+            }
+            case 'V': return sum_simd_verify() + input_verify() == 0 ? 0 : EXIT_FAILURE;
+            case 'P': perf = 1; break;
+            case 'h': usage(argv[0]); return 0;
+            default:  usage(argv[0]); return EXIT_FAILURE;
+        }
+    }
 
-    if (pthread_create(&t1, &attr, runner, p1) != 0) { perror("pthread_create t1"); return EXIT_FAILURE; }
-    if (pthread_create(&t2, &attr, runner, p2) != 0) { perror("pthread_create t2"); return EXIT_FAILURE; }
+    if (repeat < 1) repeat = 1;
 
-    void* r1; void* r2;
-    if (pthread_join(t1, &r1) != 0) { perror("pthread_join t1"); return EXIT_FAILURE; }
-    if (pthread_join(t2, &r2) != 0) { perror("pthread_join t2"); return EXIT_FAILURE; }
+    // Counters are inherited by threads created after this, so start before the pool.
+    int r_total = -1, r_load = -1, r_reduce = -1, r_stats = -1;
+    if (perf && perfctr_init(PERFCTR_INHERIT) == 0) {
+        r_total = perfctr_region("total");
+        r_load = perfctr_region("load");
+        r_reduce = perfctr_region("reduce");
+        r_stats = perfctr_region("stats");
+    }
+    perfctr_start(r_total);
 
+    if (!spawn) {
+        opt.pool = wspool_create(opt.nthreads);
+        if (!opt.pool) { perror("wspool_create"); return EXIT_FAILURE; }
+    }
+    int threads = opt.pool ? wspool_size(opt.pool)
+                : opt.nthreads > 0 ? opt.nthreads : reduce_default_threads();
+    const char* engine = opt.pool ? "pool"
+                       : opt.schedule == REDUCE_DYNAMIC ? "dynamic" : "static";
+
+    numeric_input in = { list_data, sizeof(list_data) / sizeof(list_data[0]), NULL, 0, NULL };
+    const char* source = NULL;   // NULL = the lab list (no timing line)
     long long total = 0;
-    if (r1) { total += *(long long*)r1; free(r1); }
-    if (r2) { total += *(long long*)r2; free(r2); }
+    int status = EXIT_FAILURE;
+    double t0 = now_sec();
+    double load_sec = 0;         // mapping/parsing a file, reported apart from the reductions
+
+    if (stream) {
+        source = "stdin";
+        // Reading and summing overlap here, so it is all one region.
+        perfctr_start(r_reduce);
+        int rc = input_stream_sum(STDIN_FILENO, block, &opt, &total, &in.count);
+        perfctr_stop(r_reduce);
+        if (rc != 0) {
+            perror("input_stream_sum");
+            goto out;
+        }
+    } else {
+        perfctr_start(r_load);
+        if (bin_path) {
+            source = bin_path;
+            if (input_map_binary(bin_path, &in) != 0) { perror(bin_path); goto out; }
+        } else if (text_path) {
+            source = text_path;
+            if (input_parse_text(text_path, threads, &in) != 0) { perror(text_path); goto out; }
+        } else if (count > 0) {
+            source = "generated";
+            in.owned = malloc(count * sizeof(int));
+            if (!in.owned) { perror("malloc"); goto out; }
+            for (size_t i = 0; i < count; ++i) in.owned[i] = (int)(i % 1000) + 1;
+            in.data = in.owned;
+            in.count = count;
+        }
+        perfctr_stop(r_load);
+        // Time only the reductions; loading a file is reported separately and
+        // the generator not at all, so -f/-T and -n figures compare directly.
+        if (bin_path || text_path) load_sec = now_sec() - t0;
+        t0 = now_sec();
+
+        perfctr_start(r_reduce);
+        for (int r = 0; r < repeat; ++r) {
+            if (reduce_sum_int(in.data, in.count, &opt, &total) != 0) {
+                perror("reduce_sum_int");
+                goto out;
+            }
+        }
+        perfctr_stop(r_reduce);
+    }
+    double dt = (now_sec() - t0) / repeat;
 
     printf("Sum of numbers in the list is: %lld\n", total);
-    return 0;
+    if (source || repeat > 1) {
+        printf("%s: %zu ints, %d threads, %s, %s: %.3f ms per reduction (%.2f GB/s)\n",
+               source ? source : "list", in.count, threads, engine,
+               sum_simd_name(sum_simd_level()),
+               dt * 1e3, (double)(in.count * sizeof(int)) / dt / 1e9);
+        if (load_sec > 0) printf("%s: loaded in %.3f ms\n", source, load_sec * 1e3);
+    }
+
+    if (want_stats && !stream) {
+        perfctr_start(r_stats);
+        int rc = print_stats(&opt, &in, hist.bins ? &hist : NULL);
+        perfctr_stop(r_stats);
+        if (rc != 0) goto out;
+    }
+    status = 0;
+
+out:
+    if (!stream) input_release(&in);
+    wspool_destroy(opt.pool);
+    perfctr_stop(r_total);
+    perfctr_report(stderr);
+    return status;
 }
@@ -0,0 +1,132 @@
+// fpsum.c
+// Implementation of the deterministic sums declared in fpsum.h.
+//
+// Must not be compiled with -ffast-math (or -fassociative-math): the whole
+// point is that the compiler keeps the order of additions written here.
+
+#define _POSIX_C_SOURCE 200809L
+#include "fpsum.h"
+
+#ifdef __FAST_MATH__
+#error "fpsum.c must not be built with -ffast-math: reassociation breaks bit-reproducibility"
+#endif
+
+#include <errno.h>
+#include <math.h>
+#include <stdlib.h>
+
+#define LANES        8
+#define PAIRWISE_LEAF 64   // below this, a fixed 8-lane loop; above, split in half
+
+// One Neumaier step: s + c tracks the exact running sum much more closely than s alone.
+static inline void neumaier_add(double* s, double* c, double x) {
+    double t = *s + x;
+    if (fabs(*s) >= fabs(x)) *c += (*s - t) + x;
+    else                     *c += (x - t) + *s;
+    *s = t;
+}
+
+// Fixed-order pairwise tree over an array of doubles (used for block results).
+static double pairwise_f64(const double* a, size_t n) {
+    if (n <= PAIRWISE_LEAF) {
+        double lane[LANES] = { 0 };
+        size_t i = 0;
+        for (; i + LANES <= n; i += LANES)
+            for (int l = 0; l < LANES; ++l) lane[l] += a[i + l];
+        for (int l = 0; i < n; ++i, ++l) lane[l] += a[i];
+        return ((lane[0] + lane[1]) + (lane[2] + lane[3])) + ((lane[4] + lane[5]) + (lane[6] + lane[7]));
+    }
+    size_t half = n / 2;
+    return pairwise_f64(a, half) + pairwise_f64(a + half, n - half);
+}
+
+// Block kernels for one element type. Everything below depends only on the
+// block's contents, so any thread computing a block gets the same bits.
+#define FPSUM_DEFINE(T, NAME)                                                       \
+    static double NAME##_pairwise(const T* a, size_t n) {                           \
+        if (n <= PAIRWISE_LEAF) {                                                   \
+            double lane[LANES] = { 0 };                                             \
+            size_t i = 0;                                                           \
+            for (; i + LANES <= n; i += LANES)                                      \
+                for (int l = 0; l < LANES; ++l) lane[l] += (double)a[i + l];        \
+            for (int l = 0; i < n; ++i, ++l) lane[l] += (double)a[i];               \
+            return ((lane[0] + lane[1]) + (lane[2] + lane[3]))                      \
+                 + ((lane[4] + lane[5]) + (lane[6] + lane[7]));                     \
+        }                                                                           \
+        size_t half = n / 2;                                                        \
+        return NAME##_pairwise(a, half) + NAME##_pairwise(a + half, n - half);      \
+    }                                                                               \
+                                                                                    \
+    /* 8 independent compensated accumulators, folded in a fixed order */          \
+    static void NAME##_neumaier(const T* a, size_t n, double* sum, double* comp) {  \
+        double s[LANES] = { 0 }, c[LANES] = { 0 };                                  \
+        size_t i = 0;                                                               \
+        for (; i + LANES <= n; i += LANES)                                          \
+            for (int l = 0; l < LANES; ++l) neumaier_add(&s[l], &c[l], (double)a[i + l]); \
+        for (int l = 0; i < n; ++i, ++l) neumaier_add(&s[l], &c[l], (double)a[i]);  \
+        double S = 0.0, C = 0.0;                                                    \
+        for (int l = 0; l < LANES; ++l) {                                           \
+            neumaier_add(&S, &C, s[l]);                                             \
+            C += c[l];                                                              \
+        }                                                                           \
+        *sum = S;                                                                   \
+        *comp = C;                                                                  \
+    }                                                                               \
+                                                                                    \
+    typedef struct {                                                                \
+        const T* a;                                                                 \
+        size_t n;                                                                   \
+        fpsum_method method;                                                        \
+        double* sums;                                                               \
+        double* comps;                                                              \
+    } NAME##_job;                                                                   \
+                                                                                    \
+    static void NAME##_blocks(size_t from, size_t to, int worker, void* arg) {      \
+        (void)worker;                                                               \
+        NAME##_job* j = (NAME##_job*)arg;                                           \
+        for (size_t b = from; b < to; ++b) {                                        \
+            size_t lo = b * FPSUM_BLOCK;                                            \
+            size_t len = (j->n - lo < FPSUM_BLOCK) ? j->n - lo : FPSUM_BLOCK;       \
+            if (j->method == FPSUM_PAIRWISE)                                        \
+                j->sums[b] = NAME##_pairwise(j->a + lo, len);                       \
+            else                                                                    \
+                NAME##_neumaier(j->a + lo, len, &j->sums[b], &j->comps[b]);         \
+        }                                                                           \
+    }                                                                               \
+                                                                                    \
+    int fpsum_##NAME(wspool* pool, const T* a, size_t n, fpsum_method method,       \
+                     double* out) {                                                 \
+        size_t nb = (n + FPSUM_BLOCK - 1) / FPSUM_BLOCK;                            \
+        if (nb == 0) { *out = 0.0; return 0; }                                      \
+        double* sums = malloc(nb * sizeof(double));                                 \
+        double* comps = (method == FPSUM_NEUMAIER) ? malloc(nb * sizeof(double)) : NULL; \
+        if (!sums || (method == FPSUM_NEUMAIER && !comps)) {                        \
+            free(sums); free(comps);                                                \
+            errno = ENOMEM;                                                         \
+            return -1;                                                              \
+        }                                                                           \
+        NAME##_job j = { a, n, method, sums, comps };                               \
+        wspool_parallel_for(pool, nb, 8, NAME##_blocks, &j);                        \
+                                                                                    \
+        /* Combine block results in a fixed order on this thread. */               \
+        if (method == FPSUM_PAIRWISE) {                                             \
+            *out = pairwise_f64(sums, nb);                                          \
+        } else {                                                                    \
+            double S = 0.0, C = 0.0;                                                \
+            for (size_t b = 0; b < nb; ++b) {                                       \
+                neumaier_add(&S, &C, sums[b]);                                      \
+                C += comps[b];                                                      \
+            }                                                                       \
+            *out = S + C;                                                           \
+        }                                                                           \
+        free(sums);                                                                 \
+        free(comps);                                                                \
+        return 0;                                                                   \
+    }
+
+FPSUM_DEFINE(double, f64)
+FPSUM_DEFINE(float,  f32)
+
+const char* fpsum_name(fpsum_method method) {
+    return method == FPSUM_PAIRWISE ? "pairwise" : "neumaier";
+}
@@ -0,0 +1,35 @@
+// fpsum.h
+// Deterministic parallel floating-point sums.
+//
+// A plain split-and-add parallel sum rounds differently depending on how many
+// threads there are and where the ranges are cut, so the same data can give
+// different last bits on different machines. These sums fix the order of
+// operations instead: the array is cut into FPSUM_BLOCK-sized blocks at fixed
+// positions, every block is summed by the same sequential algorithm no matter
+// which thread runs it, and the block results are combined in a fixed order on
+// the calling thread. The result is bit-identical for any thread count.
+
+#ifndef FPSUM_H
+#define FPSUM_H
+
+#include <stddef.h>
+
+#include "wspool.h"
+
+#define FPSUM_BLOCK 4096
+
+typedef enum {
+    FPSUM_PAIRWISE,   // pairwise (tree) sum inside blocks, pairwise tree over blocks
+    FPSUM_NEUMAIER    // compensated (Kahan-Babuska-Neumaier) sum, merged with compensation
+} fpsum_method;
+
+// Sum a[0..n-1]. Result depends only on the data and the method, never on the
+// pool size. Returns 0, or -1 if scratch memory could not be allocated.
+int fpsum_f64(wspool* pool, const double* a, size_t n, fpsum_method method, double* out);
+
+// Same for floats; blocks are accumulated in double.
+int fpsum_f32(wspool* pool, const float* a, size_t n, fpsum_method method, double* out);
+
+const char* fpsum_name(fpsum_method method);
+
+#endif // FPSUM_H
@@ -0,0 +1,337 @@
+// input.c
+// Implementation of the numeric input modes declared in input.h.
+
+#define _POSIX_C_SOURCE 200809L
+#define _DEFAULT_SOURCE   // madvise
+#include "input.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// ---------- mmap helpers ----------
+
+static int map_file(const char* path, void** map, size_t* len) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return -1;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0) { int e = errno; close(fd); errno = e; return -1; }
+
+    *len = (size_t)st.st_size;
+    *map = NULL;
+    if (*len > 0) {
+        void* p = mmap(NULL, *len, PROT_READ, MAP_SHARED, fd, 0);
+        if (p == MAP_FAILED) { int e = errno; close(fd); errno = e; return -1; }
+        madvise(p, *len, MADV_SEQUENTIAL);   // hint only; ignore failure
+        *map = p;
+    }
+    close(fd);   // the mapping keeps the file alive
+    return 0;
+}
+
+int input_map_binary(const char* path, numeric_input* in) {
+    memset(in, 0, sizeof(*in));
+    if (map_file(path, &in->map, &in->map_len) != 0) return -1;
+    in->data  = (const int*)in->map;
+    in->count = in->map_len / sizeof(int);
+    return 0;
+}
+
+// ---------- Parallel text parsing ----------
+
+typedef struct {
+    const char* text;
+    size_t from, to;      // byte range; tokens *starting* in [from, to) belong here
+    size_t len;           // whole text length (a token may run past `to`)
+    size_t count;         // pass 1: tokens found
+    int* out;             // pass 2: where to store them
+    int bad;              // errno for the first bad token: EINVAL malformed, ERANGE outside int
+} parse_job;
+
+static int is_sep(char c) {
+    return c == ' ' || c == '\n' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+}
+
+// Parses (or just counts, when out == NULL) the tokens of one range.
+static void* parse_range(void* arg) {
+    parse_job* j = (parse_job*)arg;
+    const char* s = j->text;
+    size_t i = j->from, n = 0;
+
+    while (i < j->to) {
+        if (is_sep(s[i])) { ++i; continue; }
+
+        int neg = 0;
+        if (s[i] == '-' || s[i] == '+') { neg = (s[i] == '-'); ++i; }
+
+        // A token may run past j->to; it still belongs to the range it starts in.
+        // v stops growing just past -INT_MIN, so long digit runs cannot overflow it.
+        long long v = 0;
+        size_t digits = 0;
+        while (i < j->len && s[i] >= '0' && s[i] <= '9') {
+            if (v <= (long long)INT_MAX + 1) v = v * 10 + (s[i] - '0');
+            ++i; ++digits;
+        }
+        if (digits == 0 || (i < j->len && !is_sep(s[i]))) {
+            j->bad = EINVAL;
+            return NULL;
+        }
+        if (v > (neg ? (long long)INT_MAX + 1 : (long long)INT_MAX)) {
+            j->bad = ERANGE;
+            return NULL;
+        }
+        if (j->out) j->out[n] = (int)(neg ? -v : v);
+        ++n;
+    }
+    j->count = n;
+    return NULL;
+}
+
+static int run_jobs(parse_job* jobs, int T) {
+    pthread_t* tids = malloc(sizeof(pthread_t) * (size_t)T);
+    if (!tids) { errno = ENOMEM; return -1; }
+
+    int started = 1, err = 0;
+    for (; started < T; ++started) {
+        err = pthread_create(&tids[started], NULL, parse_range, &jobs[started]);
+        if (err != 0) break;
+    }
+    parse_range(&jobs[0]);
+    for (int i = 1; i < started; ++i) pthread_join(tids[i], NULL);
+    free(tids);
+
+    if (err != 0) { errno = err; return -1; }
+    for (int i = 0; i < T; ++i) {
+        if (jobs[i].bad) { errno = jobs[i].bad; return -1; }
+    }
+    return 0;
+}
+
+int input_parse_text(const char* path, int nthreads, numeric_input* in) {
+    memset(in, 0, sizeof(*in));
+
+    void* map; size_t len;
+    if (map_file(path, &map, &len) != 0) return -1;
+
+    const char* text = (const char*)map;
+
+    int T = nthreads > 0 ? nthreads : reduce_default_threads();
+    if ((size_t)T > len / 4096 + 1) T = (int)(len / 4096 + 1);   // tiny files: fewer threads
+
+    parse_job* jobs = calloc((size_t)T, sizeof(parse_job));
+    if (!jobs) goto fail_nomem;
+
+    // Split into byte ranges and move each boundary forward to the start of a token.
+    for (int i = 0; i < T; ++i) {
+        size_t b = len * (size_t)i / (size_t)T;
+        while (b > 0 && b < len && !is_sep(text[b - 1])) ++b;
+        jobs[i].text = text;
+        jobs[i].len  = len;
+        jobs[i].from = b;
+    }
+    for (int i = 0; i < T; ++i) {
+        jobs[i].to = (i + 1 < T) ? jobs[i + 1].from : len;
+        if (jobs[i].to < jobs[i].from) jobs[i].to = jobs[i].from;
+    }
+
+    // Pass 1: count tokens per range; pass 2: parse straight into the final array.
+    if (run_jobs(jobs, T) != 0) goto fail;
+
+    size_t total = 0;
+    for (int i = 0; i < T; ++i) total += jobs[i].count;
+
+    int* out = malloc((total ? total : 1) * sizeof(int));
+    if (!out) goto fail_nomem;
+    size_t off = 0;
+    for (int i = 0; i < T; ++i) {
+        jobs[i].out = out + off;
+        off += jobs[i].count;
+    }
+    if (run_jobs(jobs, T) != 0) { free(out); goto fail; }
+
+    free(jobs);
+    if (map) munmap(map, len);
+    in->owned = out;
+    in->data  = out;
+    in->count = total;
+    return 0;
+
+fail_nomem:
+    errno = ENOMEM;
+fail: {
+        int e = errno;
+        free(jobs);
+        if (map) munmap(map, len);
+        errno = e;
+        return -1;
+    }
+}
+
+// ---------- Double-buffered streaming ----------
+
+typedef struct {
+    int fd;
+    size_t block;
+    int* buf[2];
+    size_t len[2];
+    int full[2];
+    int last[2];
+    int err;
+    pthread_mutex_t m;
+    pthread_cond_t cv;
+} stream_state;
+
+// Fill one buffer completely (or up to EOF). Returns bytes read, -1 on error.
+static ssize_t read_block(int fd, void* buf, size_t want) {
+    size_t have = 0;
+    while (have < want) {
+        ssize_t r = read(fd, (char*)buf + have, want - have);
+        if (r < 0) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        if (r == 0) break;
+        have += (size_t)r;
+    }
+    return (ssize_t)have;
+}
+
+static void* stream_reader(void* arg) {
+    stream_state* st = (stream_state*)arg;
+    for (int idx = 0;; idx ^= 1) {
+        pthread_mutex_lock(&st->m);
+        while (st->full[idx]) pthread_cond_wait(&st->cv, &st->m);
+        pthread_mutex_unlock(&st->m);
+
+        size_t want = st->block * sizeof(int);
+        ssize_t got = read_block(st->fd, st->buf[idx], want);
+
+        pthread_mutex_lock(&st->m);
+        int done = (got < 0 || (size_t)got < want);
+        if (got < 0) { st->err = errno; got = 0; }
+        st->len[idx]  = (size_t)got / sizeof(int);   // a trailing partial int is dropped
+        st->last[idx] = done;
+        st->full[idx] = 1;
+        pthread_cond_broadcast(&st->cv);
+        pthread_mutex_unlock(&st->m);
+        if (done) break;
+    }
+    return NULL;
+}
+
+int input_stream_sum(int fd, size_t block_elems, const reduce_options* opt,
+                     long long* out, size_t* count) {
+    stream_state st;
+    memset(&st, 0, sizeof(st));
+    st.fd = fd;
+    st.block = block_elems ? block_elems : INPUT_DEFAULT_BLOCK;
+    st.buf[0] = malloc(st.block * sizeof(int));
+    st.buf[1] = malloc(st.block * sizeof(int));
+    if (!st.buf[0] || !st.buf[1]) {
+        free(st.buf[0]); free(st.buf[1]);
+        errno = ENOMEM;
+        return -1;
+    }
+    pthread_mutex_init(&st.m, NULL);
+    pthread_cond_init(&st.cv, NULL);
+
+    pthread_t reader;
+    int err = pthread_create(&reader, NULL, stream_reader, &st);
+    if (err != 0) {
+        free(st.buf[0]); free(st.buf[1]);
+        errno = err;
+        return -1;
+    }
+
+    long long total = 0;
+    size_t n_total = 0;
+    int sum_err = 0;
+    for (int idx = 0;; idx ^= 1) {
+        pthread_mutex_lock(&st.m);
+        while (!st.full[idx]) pthread_cond_wait(&st.cv, &st.m);
+        size_t n = st.len[idx];
+        int last = st.last[idx];
+        pthread_mutex_unlock(&st.m);
+
+        long long s = 0;
+        if (!sum_err && n > 0 && reduce_sum_int(st.buf[idx], n, opt, &s) != 0) sum_err = errno;
+        total += s;
+        n_total += n;
+
+        pthread_mutex_lock(&st.m);
+        st.full[idx] = 0;
+        pthread_cond_broadcast(&st.cv);
+        pthread_mutex_unlock(&st.m);
+        if (last) break;
+    }
+
+    pthread_join(reader, NULL);
+    pthread_mutex_destroy(&st.m);
+    pthread_cond_destroy(&st.cv);
+    free(st.buf[0]);
+    free(st.buf[1]);
+
+    if (st.err || sum_err) { errno = st.err ? st.err : sum_err; return -1; }
+    *out = total;
+    if (count) *count = n_total;
+    return 0;
+}
+
+void input_release(numeric_input* in) {
+    if (in->map) munmap(in->map, in->map_len);
+    free(in->owned);
+    memset(in, 0, sizeof(*in));
+}
+
+// ---------- Self-check (PLthreads -V) ----------
+
+int input_verify(void) {
+    static const struct {
+        const char* text;
+        int err;            // expected errno, 0 = parses
+        long long sum;
+    } cases[] = {
+        { "1 2 3",                        0,      6 },
+        { "-2147483648 2147483647",       0,      -1 },
+        { "2147483648",                   ERANGE, 0 },
+        { "-2147483649",                  ERANGE, 0 },
+        { "1 2 99999999999",              ERANGE, 0 },
+        { "1 99999999999999999999999",    ERANGE, 0 },
+        { "12x",                          EINVAL, 0 },
+    };
+    const char* dir = getenv("TMPDIR");
+    char path[4096];
+    int failures = 0;
+
+    for (size_t c = 0; c < sizeof(cases) / sizeof(cases[0]); ++c) {
+        snprintf(path, sizeof(path), "%s/input_verify.XXXXXX", dir ? dir : "/tmp");
+        int fd = mkstemp(path);
+        if (fd < 0) { perror("mkstemp"); return 1; }
+        size_t len = strlen(cases[c].text);
+        int wrote = write(fd, cases[c].text, len) == (ssize_t)len;
+        close(fd);
+
+        numeric_input in;
+        int rc = wrote ? input_parse_text(path, 2, &in) : -1;
+        int err = rc == 0 ? 0 : errno;
+        long long sum = 0;
+        if (rc == 0) {
+            for (size_t i = 0; i < in.count; ++i) sum += in.data[i];
+            input_release(&in);
+        }
+        unlink(path);
+
+        int ok = wrote && err == cases[c].err && (err != 0 || sum == cases[c].sum);
+        printf("text    %-28s %s\n", cases[c].text, ok ? "ok" : "MISMATCH");
+        failures += !ok;
+    }
+    return failures;
+}
@@ -0,0 +1,48 @@
+// input.h
+// Large numeric inputs for the parallel sum programs.
+//
+//   input_map_binary  mmap a file of native-endian 32-bit ints (zero copy)
+//   input_parse_text  parse a whitespace-separated text file in parallel chunks
+//   input_stream_sum  sum a binary int stream (e.g. stdin) block by block, with
+//                     a reader thread filling one buffer while the other is summed
+
+#ifndef INPUT_H
+#define INPUT_H
+
+#include <stddef.h>
+
+#include "reduce.h"
+
+typedef struct {
+    const int* data;
+    size_t count;
+    void* map;        // mmap'd region to release (NULL if none)
+    size_t map_len;
+    int* owned;       // heap array to release (NULL if none)
+} numeric_input;
+
+#define INPUT_DEFAULT_BLOCK ((size_t)1 << 20)   // ints per streaming block (4 MiB)
+
+// Map path read-only and shared. Trailing bytes that do not form a whole int
+// are ignored. Returns 0 on success, -1 on failure (errno set).
+int input_map_binary(const char* path, numeric_input* in);
+
+// Parse decimal integers separated by whitespace using nthreads threads
+// (<= 0: online cores). Returns 0 on success, -1 on failure (errno set;
+// EINVAL for a malformed token, ERANGE for a value outside int).
+int input_parse_text(const char* path, int nthreads, numeric_input* in);
+
+// Read native-endian ints from fd until EOF in blocks of block_elems ints
+// (0: INPUT_DEFAULT_BLOCK), summing each block with reduce_sum_int(opt) while
+// the next block is being read. *count receives the number of ints consumed.
+// Returns 0 on success, -1 on failure (errno set).
+int input_stream_sum(int fd, size_t block_elems, const reduce_options* opt,
+                     long long* out, size_t* count);
+
+void input_release(numeric_input* in);
+
+// Parse a few small text files (valid, out-of-range and malformed tokens) and
+// check the results; prints one line per case. Returns the number of failures.
+int input_verify(void);
+
+#endif // INPUT_H
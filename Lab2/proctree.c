@@ -0,0 +1,160 @@
+// proctree.c
+// Implementation of the spec-driven process tree builder declared in proctree.h.
+
+#define _POSIX_C_SOURCE 200809L
+#include "proctree.h"
+
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+// ---------- Spec parsing ----------
+
+static int add_node(proctree* t, int parent, int* cap) {
+    if (t->count >= PROCTREE_MAX_NODES) {
+        fprintf(stderr, "proctree: more than %d processes\n", PROCTREE_MAX_NODES);
+        return -1;
+    }
+    if (t->count == *cap) {
+        int ncap = *cap ? *cap * 2 : 64;
+        proctree_node* n = realloc(t->nodes, sizeof(proctree_node) * (size_t)ncap);
+        if (!n) { perror("realloc"); return -1; }
+        t->nodes = n;
+        *cap = ncap;
+    }
+
+    int id = t->count++;
+    proctree_node* n = &t->nodes[id];
+    n->parent = parent;
+    n->depth = parent < 0 ? 0 : t->nodes[parent].depth + 1;
+    n->first_child = -1;
+    n->next_sibling = -1;
+    n->last_child = -1;
+    n->nchildren = 0;
+    if (n->depth > t->max_depth) t->max_depth = n->depth;
+
+    if (parent >= 0) {
+        // Append so siblings keep their left-to-right order.
+        proctree_node* p = &t->nodes[parent];
+        if (p->first_child < 0) p->first_child = id;
+        else t->nodes[p->last_child].next_sibling = id;
+        p->last_child = id;
+        p->nchildren++;
+    }
+    return id;
+}
+
+static int parse_parens(const char* s, proctree* t, int* cap) {
+    int cur = -1;
+    for (; *s; ++s) {
+        if (isspace((unsigned char)*s)) continue;
+        if (*s == '(') {
+            if (cur < 0 && t->count > 0) goto bad;   // a second root
+            int id = add_node(t, cur, cap);
+            if (id < 0) return -1;
+            cur = id;
+        } else if (*s == ')') {
+            if (cur < 0) goto bad;
+            cur = t->nodes[cur].parent;
+        } else {
+            goto bad;
+        }
+    }
+    if (cur >= 0 || t->count == 0) goto bad;
+    return 0;
+bad:
+    fprintf(stderr, "proctree: malformed tree spec\n");
+    return -1;
+}
+
+static int parse_fanout(const char* s, proctree* t, int* cap) {
+    if (add_node(t, -1, cap) < 0) return -1;
+    int level_start = 0, level_end = 1;   // nodes of the current deepest level
+
+    while (*s) {
+        char* end;
+        long k = strtol(s, &end, 10);
+        if (end == s || k < 0) {
+            fprintf(stderr, "proctree: malformed fanout list\n");
+            return -1;
+        }
+        for (int p = level_start; p < level_end; ++p) {
+            for (long c = 0; c < k; ++c) {
+                if (add_node(t, p, cap) < 0) return -1;
+            }
+        }
+        level_start = level_end;
+        level_end = t->count;
+        s = end;
+        if (*s == ',') ++s;
+    }
+    return 0;
+}
+
+int proctree_parse(const char* spec, proctree* t) {
+    memset(t, 0, sizeof(*t));
+    int cap = 0;
+    while (isspace((unsigned char)*spec)) ++spec;
+    int rc = (*spec == '(') ? parse_parens(spec, t, &cap) : parse_fanout(spec, t, &cap);
+    if (rc != 0) proctree_free(t);
+    return rc;
+}
+
+void proctree_free(proctree* t) {
+    free(t->nodes);
+    memset(t, 0, sizeof(*t));
+}
+
+// ---------- Building ----------
+
+// Runs in the process for `node`: fork every child first, then reap them all.
+// Returns the number of failures in this subtree.
+static int build_subtree(const proctree* t, int node, const proctree_hooks* h) {
+    if (h && h->on_start) h->on_start(t, node, h->arg);
+
+    int failed = 0;
+    for (int c = t->nodes[node].first_child; c >= 0; c = t->nodes[c].next_sibling) {
+        pid_t p = fork();
+        if (p < 0) {
+            perror("fork");
+            failed++;
+            continue;
+        }
+        if (p == 0) {
+            int f = build_subtree(t, c, h);
+            _exit(f ? 1 : 0);   // _exit: never flush stdio buffers inherited from the parent
+        }
+    }
+
+    // Only now wait, after all siblings are running.
+    failed += proc_wait_all();
+
+    if (h && h->on_done) h->on_done(t, node, h->arg);
+    return failed;
+}
+
+int proctree_build(const proctree* t, const proctree_hooks* hooks) {
+    fflush(NULL);   // children inherit stdio buffers; empty them before forking
+    return build_subtree(t, 0, hooks);
+}
+
+// ---------- Process helpers ----------
+
+pid_t proc_fork(void) {
+    pid_t p = fork();
+    if (p < 0) perror("fork");
+    return p;
+}
+
+int proc_wait_all(void) {
+    int status, failed = 0;
+    while (1) {
+        pid_t w = wait(&status);
+        if (w == -1) break; // no more children
+        if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) failed++;
+    }
+    return failed;
+}
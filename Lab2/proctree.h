@@ -0,0 +1,63 @@
+// proctree.h
+// Build a process tree from a textual spec (used by PLfork.c), plus small
+// fork/reap helpers shared with the other process-based programs.
+//
+// Two spec forms are accepted:
+//   fanout list    "3,2"                  root has 3 children, each of those has 2
+//   parenthesized  "((()())(())(()()))"   one "(...)" per process, children nested inside
+//
+// Every process forks all of its children back to back and only then waits for
+// them, so siblings (and whole subtrees) are created concurrently instead of
+// one subtree at a time.
+
+#ifndef PROCTREE_H
+#define PROCTREE_H
+
+#include <sys/types.h>
+
+#define PROCTREE_MAX_NODES (1 << 20)
+
+typedef struct {
+    int parent;        // -1 for the root
+    int depth;         // root = 0
+    int first_child;   // -1 if none
+    int next_sibling;  // -1 if none
+    int last_child;    // -1 if none (lets the parser append in O(1))
+    int nchildren;
+} proctree_node;
+
+typedef struct {
+    proctree_node* nodes;   // node 0 is the root; preorder for "(...)" specs, level order for fanout lists
+    int count;
+    int max_depth;
+} proctree;
+
+// Callbacks run inside the process that represents `node`.
+typedef struct {
+    void (*on_start)(const proctree* t, int node, void* arg);  // before forking children
+    void (*on_done)(const proctree* t, int node, void* arg);   // after reaping children
+    void* arg;
+} proctree_hooks;
+
+// Returns 0, or -1 with a message on stderr for a malformed or too large spec.
+int proctree_parse(const char* spec, proctree* t);
+void proctree_free(proctree* t);
+
+// Create the tree below the calling process, which acts as node 0. Returns in
+// the calling process only, after every descendant has exited. The result is 0
+// if every process was created and exited cleanly; otherwise it counts the
+// failed forks and failed child subtrees seen by the root.
+int proctree_build(const proctree* t, const proctree_hooks* hooks);
+
+// Helpers for any fork()-based program (also used by PLprocsum.c).
+
+// fork(), printing the error on failure. Returns like fork(): the child's pid,
+// 0 in the child, -1 on failure. The caller decides what to do about the
+// children it already has (typically: stop forking and proc_wait_all()).
+pid_t proc_fork(void);
+
+// Reap every child of the calling process. Returns how many did not exit
+// normally with status 0 (killed by a signal, or nonzero exit).
+int proc_wait_all(void);
+
+#endif // PROCTREE_H
@@ -0,0 +1,132 @@
+// reduce.c
+// Implementation of the N-thread reduction engine declared in reduce.h.
+
+#define _POSIX_C_SOURCE 200809L
+#include "reduce.h"
+#include "sum_simd.h"
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#define CACHE_LINE 64
+
+// One per worker; aligned so neighbouring workers never share a cache line.
+typedef struct {
+    _Alignas(CACHE_LINE) long long sum;
+    const int* data;
+    size_t from, to;              // [from, to) for REDUCE_STATIC
+    size_t n, chunk;              // REDUCE_DYNAMIC bounds
+    atomic_size_t* cursor;        // shared by all workers in REDUCE_DYNAMIC
+} worker;
+
+int reduce_default_threads(void) {
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return n < 1 ? 1 : (int)n;
+}
+
+static long long sum_range(const int* data, size_t from, size_t to) {
+    return sum_i32(data + from, to - from);   // SIMD kernel picked at startup
+}
+
+static void* static_runner(void* arg) {
+    worker* w = (worker*)arg;
+    w->sum = sum_range(w->data, w->from, w->to);
+    return NULL;
+}
+
+static void* dynamic_runner(void* arg) {
+    worker* w = (worker*)arg;
+    long long s = 0;
+    for (;;) {
+        size_t from = atomic_fetch_add_explicit(w->cursor, w->chunk, memory_order_relaxed);
+        if (from >= w->n) break;
+        size_t to = (w->n - from < w->chunk) ? w->n : from + w->chunk;
+        s += sum_range(w->data, from, to);
+    }
+    w->sum = s;
+    return NULL;
+}
+
+// ---------- Pool-backed path ----------
+
+static void acc_zero(void* acc, void* arg) {
+    (void)arg;
+    *(long long*)acc = 0;
+}
+
+static void acc_sum(size_t from, size_t to, void* acc, void* arg) {
+    *(long long*)acc += sum_range((const int*)arg, from, to);
+}
+
+static void acc_add(void* into, const void* from, void* arg) {
+    (void)arg;
+    *(long long*)into += *(const long long*)from;
+}
+
+int reduce_sum_int(const int* data, size_t n, const reduce_options* opt, long long* out) {
+    reduce_options o = { 0, REDUCE_STATIC, 0, NULL };
+    if (opt) o = *opt;
+
+    if (o.pool) {
+        size_t grain = o.chunk ? o.chunk : REDUCE_DEFAULT_CHUNK;
+        return wspool_parallel_reduce(o.pool, n, grain, sizeof(long long),
+                                      acc_zero, acc_sum, acc_add, (void*)data, out);
+    }
+
+    if (o.nthreads <= 0) o.nthreads = reduce_default_threads();
+    if (o.chunk == 0) o.chunk = REDUCE_DEFAULT_CHUNK;
+
+    // No point in more threads than elements (static) or chunks (dynamic).
+    size_t units = (o.schedule == REDUCE_DYNAMIC) ? (n + o.chunk - 1) / o.chunk : n;
+    if (units == 0) units = 1;
+    if ((size_t)o.nthreads > units) o.nthreads = (int)units;
+
+    int T = o.nthreads;
+    worker* ws = aligned_alloc(CACHE_LINE, sizeof(worker) * (size_t)T);
+    pthread_t* tids = malloc(sizeof(pthread_t) * (size_t)T);
+    if (!ws || !tids) {
+        free(ws); free(tids);
+        errno = ENOMEM;
+        return -1;
+    }
+
+    atomic_size_t cursor;
+    atomic_init(&cursor, 0);
+    void* (*fn)(void*) = (o.schedule == REDUCE_DYNAMIC) ? dynamic_runner : static_runner;
+
+    for (int i = 0; i < T; ++i) {
+        ws[i].sum    = 0;
+        ws[i].data   = data;
+        ws[i].from   = (size_t)((unsigned __int128)n * (unsigned)i / (unsigned)T);
+        ws[i].to     = (size_t)((unsigned __int128)n * (unsigned)(i + 1) / (unsigned)T);
+        ws[i].n      = n;
+        ws[i].chunk  = o.chunk;
+        ws[i].cursor = &cursor;
+    }
+
+    // Workers 1..T-1 get their own thread; the caller does worker 0's share.
+    int started = 1, err = 0;
+    for (; started < T; ++started) {
+        err = pthread_create(&tids[started], NULL, fn, &ws[started]);
+        if (err != 0) break;
+    }
+    fn(&ws[0]);
+
+    for (int i = 1; i < started; ++i) {
+        pthread_join(tids[i], NULL);
+    }
+
+    long long total = 0;
+    if (err == 0) {
+        for (int i = 0; i < T; ++i) total += ws[i].sum;
+        *out = total;
+    }
+
+    free(ws);
+    free(tids);
+    if (err != 0) { errno = err; return -1; }
+    return 0;
+}
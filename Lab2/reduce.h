@@ -0,0 +1,41 @@
+// reduce.h
+// N-thread parallel sum over arbitrarily large int arrays (used by PLthreads.c).
+//
+// The array is split across worker threads either statically (one contiguous
+// slice per thread) or dynamically (threads grab fixed-size chunks from a shared
+// atomic cursor). Each worker writes its partial sum into its own cache-line
+// sized slot of a single preallocated array; the caller's thread acts as worker 0.
+//
+// If opt->pool is set, the sum runs on that persistent work-stealing pool
+// instead (see wspool.h): no threads are created per call, the schedule field
+// is ignored and chunk becomes the splitting grain.
+
+#ifndef REDUCE_H
+#define REDUCE_H
+
+#include <stddef.h>
+
+#include "wspool.h"
+
+typedef enum {
+    REDUCE_STATIC,   // thread i sums [n*i/T, n*(i+1)/T)
+    REDUCE_DYNAMIC   // threads pull `chunk` elements at a time until exhausted
+} reduce_schedule;
+
+typedef struct {
+    int nthreads;              // <= 0 means "number of online cores"
+    reduce_schedule schedule;
+    size_t chunk;              // chunk size for REDUCE_DYNAMIC (0 = REDUCE_DEFAULT_CHUNK)
+    wspool* pool;              // optional persistent pool; NULL = spawn threads per call
+} reduce_options;
+
+#define REDUCE_DEFAULT_CHUNK ((size_t)1 << 16)
+
+// Number of online cores (at least 1).
+int reduce_default_threads(void);
+
+// Sum data[0..n-1] into *out. opt may be NULL for defaults.
+// Returns 0 on success, -1 on failure (errno set; no threads left running).
+int reduce_sum_int(const int* data, size_t n, const reduce_options* opt, long long* out);
+
+#endif // REDUCE_H
@@ -0,0 +1,182 @@
+// scan.c
+// Implementation of the parallel scan / segmented sum API declared in scan.h.
+
+#define _POSIX_C_SOURCE 200809L
+#include "scan.h"
+#include "sum_simd.h"
+
+#include <errno.h>
+#include <stdlib.h>
+
+#define BLOCKS_PER_WORKER 4                 // a little slack for stealing
+#define MIN_BLOCK         ((size_t)1 << 14) // below this, threading costs more than it saves
+
+static size_t block_count(const wspool* pool, size_t n) {
+    if (wspool_size(pool) == 1) return 1;   // the fix-up pass would be pure overhead
+    size_t b = (size_t)wspool_size(pool) * BLOCKS_PER_WORKER;
+    size_t max_b = (n + MIN_BLOCK - 1) / MIN_BLOCK;
+    if (b > max_b) b = max_b;
+    return b ? b : 1;
+}
+
+static size_t block_lo(size_t n, size_t b, size_t blocks) {
+    return (size_t)((unsigned __int128)n * b / blocks);
+}
+
+// ---------- Scan ----------
+
+void scan_int_serial(const int* in, long long* out, size_t n, scan_kind kind) {
+    long long run = 0;
+    if (kind == SCAN_INCLUSIVE) {
+        for (size_t i = 0; i < n; ++i) { run += in[i]; out[i] = run; }
+    } else {
+        for (size_t i = 0; i < n; ++i) { out[i] = run; run += in[i]; }
+    }
+}
+
+typedef struct {
+    const int* in;
+    long long* out;
+    size_t n, blocks;
+    scan_kind kind;
+    long long* totals;   // pass 1: block totals; then turned into block offsets
+} scan_job;
+
+// Pass 1: scan each block on its own and remember its total.
+static void scan_local(size_t from, size_t to, int worker, void* arg) {
+    (void)worker;
+    scan_job* j = (scan_job*)arg;
+    for (size_t b = from; b < to; ++b) {
+        size_t lo = block_lo(j->n, b, j->blocks), hi = block_lo(j->n, b + 1, j->blocks);
+        scan_int_serial(j->in + lo, j->out + lo, hi - lo, j->kind);
+        long long last = (hi > lo) ? j->out[hi - 1] : 0;
+        j->totals[b] = (j->kind == SCAN_INCLUSIVE || hi == lo) ? last : last + j->in[hi - 1];
+    }
+}
+
+// Pass 2: add the block's offset to every element.
+static void scan_fixup(size_t from, size_t to, int worker, void* arg) {
+    (void)worker;
+    scan_job* j = (scan_job*)arg;
+    for (size_t b = from; b < to; ++b) {
+        long long off = j->totals[b];
+        if (off == 0) continue;
+        size_t lo = block_lo(j->n, b, j->blocks), hi = block_lo(j->n, b + 1, j->blocks);
+        long long* o = j->out;
+        for (size_t i = lo; i < hi; ++i) o[i] += off;
+    }
+}
+
+int scan_int(wspool* pool, const int* in, long long* out, size_t n, scan_kind kind) {
+    size_t blocks = block_count(pool, n);
+    if (blocks == 1) {
+        scan_int_serial(in, out, n, kind);
+        return 0;
+    }
+
+    long long* totals = malloc(blocks * sizeof(long long));
+    if (!totals) { errno = ENOMEM; return -1; }
+    scan_job j = { in, out, n, blocks, kind, totals };
+
+    wspool_parallel_for(pool, blocks, 1, scan_local, &j);
+
+    // Offset propagation: exclusive scan of the block totals (blocks is small).
+    long long run = 0;
+    for (size_t b = 0; b < blocks; ++b) {
+        long long t = totals[b];
+        totals[b] = run;
+        run += t;
+    }
+
+    wspool_parallel_for(pool, blocks, 1, scan_fixup, &j);
+    free(totals);
+    return 0;
+}
+
+// ---------- Segmented sums ----------
+
+void segmented_sum_int_serial(const int* in, const size_t* offsets, size_t m, long long* sums) {
+    for (size_t k = 0; k < m; ++k) {
+        long long s = 0;
+        for (size_t i = offsets[k]; i < offsets[k + 1]; ++i) s += in[i];
+        sums[k] = s;
+    }
+}
+
+typedef struct {
+    const int* in;
+    size_t n, blocks;
+    const size_t* offsets;
+    size_t m;
+    long long* sums;
+    size_t* carry_seg;      // per block: segment that started in an earlier block
+    long long* carry_sum;   // ... and this block's share of it
+} seg_job;
+
+// First segment k with offsets[k] > pos, i.e. one past the segment holding pos.
+static size_t seg_upper(const size_t* offsets, size_t m, size_t pos) {
+    size_t lo = 0, hi = m + 1;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (offsets[mid] > pos) hi = mid; else lo = mid + 1;
+    }
+    return lo;
+}
+
+// A block owns every segment that *starts* inside it and writes that segment's
+// sum (possibly only its first part). The one segment that started earlier and
+// runs into the block is summed as a carry and added serially afterwards, so no
+// two blocks ever write the same output slot.
+static void seg_block(size_t from, size_t to, int worker, void* arg) {
+    (void)worker;
+    seg_job* j = (seg_job*)arg;
+    for (size_t b = from; b < to; ++b) {
+        size_t lo = block_lo(j->n, b, j->blocks), hi = block_lo(j->n, b + 1, j->blocks);
+        j->carry_seg[b] = j->m;   // none
+        j->carry_sum[b] = 0;
+        if (lo == hi) continue;
+
+        size_t k = seg_upper(j->offsets, j->m, lo) - 1;   // segment holding lo
+        if (j->offsets[k] < lo) {
+            size_t end = j->offsets[k + 1] < hi ? j->offsets[k + 1] : hi;
+            j->carry_seg[b] = k;
+            j->carry_sum[b] = sum_i32(j->in + lo, end - lo);
+            ++k;
+        }
+        // Skip back over empty segments that also start at lo.
+        while (k > 0 && j->offsets[k - 1] == lo && j->offsets[k] == lo) --k;
+
+        for (; k < j->m && j->offsets[k] < hi; ++k) {
+            size_t s = j->offsets[k];
+            size_t e = j->offsets[k + 1] < hi ? j->offsets[k + 1] : hi;
+            j->sums[k] = sum_i32(j->in + s, e - s);
+        }
+    }
+}
+
+int segmented_sum_int(wspool* pool, const int* in, size_t n,
+                      const size_t* offsets, size_t m, long long* sums) {
+    if (m == 0) return 0;
+    size_t blocks = block_count(pool, n);
+
+    size_t* carry_seg = malloc(blocks * sizeof(size_t));
+    long long* carry_sum = malloc(blocks * sizeof(long long));
+    if (!carry_seg || !carry_sum) {
+        free(carry_seg); free(carry_sum);
+        errno = ENOMEM;
+        return -1;
+    }
+
+    seg_job j = { in, n, blocks, offsets, m, sums, carry_seg, carry_sum };
+    wspool_parallel_for(pool, blocks, 1, seg_block, &j);
+
+    for (size_t b = 0; b < blocks; ++b) {
+        if (carry_seg[b] < m) sums[carry_seg[b]] += carry_sum[b];
+    }
+    // Empty segments at the very end start at n and belong to no block.
+    for (size_t k = m; k > 0 && offsets[k - 1] == n; --k) sums[k - 1] = 0;
+
+    free(carry_seg);
+    free(carry_sum);
+    return 0;
+}
@@ -0,0 +1,38 @@
+// scan.h
+// Parallel prefix sums (scan) and segmented sums over int arrays, run on a
+// work-stealing pool (wspool.h).
+//
+// Scan uses the classic two-pass blocked algorithm: the array is cut into
+// blocks, every block is scanned locally in parallel, the block totals are
+// scanned serially to get each block's offset, and a second parallel pass adds
+// the offset to every element of the block (fix-up).
+
+#ifndef SCAN_H
+#define SCAN_H
+
+#include <stddef.h>
+
+#include "wspool.h"
+
+typedef enum {
+    SCAN_INCLUSIVE,   // out[i] = in[0] + ... + in[i]
+    SCAN_EXCLUSIVE    // out[i] = in[0] + ... + in[i-1], out[0] = 0
+} scan_kind;
+
+// Prefix sums of in[0..n-1] into out[0..n-1]. Returns 0, or -1 (errno set).
+int scan_int(wspool* pool, const int* in, long long* out, size_t n, scan_kind kind);
+
+// Plain serial scan, the reference for scan_int.
+void scan_int_serial(const int* in, long long* out, size_t n, scan_kind kind);
+
+// Segment k is in[offsets[k] .. offsets[k+1]-1] (offsets non-decreasing,
+// offsets[0] = 0, offsets[m] = n). Writes the m segment sums to sums[].
+// Work is split by elements, not by segments, so very uneven segment sizes
+// still load-balance. Returns 0, or -1 (errno set).
+int segmented_sum_int(wspool* pool, const int* in, size_t n,
+                      const size_t* offsets, size_t m, long long* sums);
+
+// Plain serial version, the reference for segmented_sum_int.
+void segmented_sum_int_serial(const int* in, const size_t* offsets, size_t m, long long* sums);
+
+#endif // SCAN_H
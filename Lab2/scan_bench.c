@@ -0,0 +1,133 @@
+// scan_bench.c
+// Scaling benchmark for the parallel scan and segmented sums in scan.c.
+// Build:   gcc -Wall -Wextra -std=c11 -O2 -pthread -o scan_bench scan_bench.c scan.c wspool.c sum_simd.c -lm
+// Run:     ./scan_bench                  # 50M ints, thread counts 1, 2, 4, ... up to the core count
+//          ./scan_bench -n 200000000 -t 16 -r 5
+//
+// Flags:
+//   -n <count>   number of ints (default 50000000)
+//   -t <int>     largest thread count to try (default: online core count)
+//   -r <int>     repetitions per measurement; the best time is reported (default 3)
+//   -s <count>   number of segments for the segmented sum (default 100000)
+//
+// Every parallel result is checked against the serial version before its time is printed.
+
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "scan.h"
+#include "wspool.h"
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static int cmp_size(const void* a, const void* b) {
+    size_t x = *(const size_t*)a, y = *(const size_t*)b;
+    return (x > y) - (x < y);
+}
+
+int main(int argc, char** argv) {
+    size_t n = 50000000, m = 100000;
+    int max_threads = 0, reps = 3;
+
+    int c;
+    while ((c = getopt(argc, argv, "n:t:r:s:h")) != -1) {
+        switch (c) {
+            case 'n': n = strtoull(optarg, NULL, 10); break;
+            case 't': max_threads = atoi(optarg); break;
+            case 'r': reps = atoi(optarg); break;
+            case 's': m = strtoull(optarg, NULL, 10); break;
+            default:
+                fprintf(stderr, "Usage: %s [-n count] [-t max_threads] [-r reps] [-s segments]\n", argv[0]);
+                return c == 'h' ? 0 : EXIT_FAILURE;
+        }
+    }
+    if (max_threads <= 0) {
+        long cores = sysconf(_SC_NPROCESSORS_ONLN);
+        max_threads = cores < 1 ? 1 : (int)cores;
+    }
+    if (reps < 1) reps = 1;
+    if (m < 1) m = 1;
+
+    int* in = malloc(n * sizeof(int));
+    long long* ref = malloc(n * sizeof(long long));
+    long long* out = malloc(n * sizeof(long long));
+    size_t* offsets = malloc((m + 1) * sizeof(size_t));
+    long long* seg_ref = malloc(m * sizeof(long long));
+    long long* seg_out = malloc(m * sizeof(long long));
+    if (!in || !ref || !out || !offsets || !seg_ref || !seg_out) { perror("malloc"); return EXIT_FAILURE; }
+
+    unsigned int rng = 42u;
+    for (size_t i = 0; i < n; ++i) in[i] = (int)(rand_r(&rng) % 2001) - 1000;
+
+    // Random cut points give very uneven segment sizes (and some empty ones).
+    offsets[0] = 0;
+    for (size_t k = 1; k < m; ++k) {
+        offsets[k] = (size_t)(((unsigned long long)rand_r(&rng) << 31 ^ (unsigned long long)rand_r(&rng)) % (n + 1));
+    }
+    offsets[m] = n;
+    qsort(offsets + 1, m - 1, sizeof(size_t), cmp_size);
+
+    // Fault every output page in now, so the first timed run (serial, or any
+    // variant with -r 1) does not pay first-touch page faults the others skip.
+    memset(ref, 0, n * sizeof(long long));
+    memset(out, 0, n * sizeof(long long));
+    memset(seg_ref, 0, m * sizeof(long long));
+    memset(seg_out, 0, m * sizeof(long long));
+
+    // Serial baselines
+    double best_scan = 1e30, best_seg = 1e30;
+    for (int r = 0; r < reps; ++r) {
+        double t0 = now_sec();
+        scan_int_serial(in, ref, n, SCAN_INCLUSIVE);
+        double t1 = now_sec();
+        segmented_sum_int_serial(in, offsets, m, seg_ref);
+        double t2 = now_sec();
+        if (t1 - t0 < best_scan) best_scan = t1 - t0;
+        if (t2 - t1 < best_seg) best_seg = t2 - t1;
+    }
+
+    printf("n=%zu segments=%zu reps=%d\n", n, m, reps);
+    printf("%-8s %12s %8s %12s %8s\n", "threads", "scan ms", "speedup", "segsum ms", "speedup");
+    printf("%-8s %12.2f %8.2f %12.2f %8.2f\n", "serial", best_scan * 1e3, 1.0, best_seg * 1e3, 1.0);
+
+    int failures = 0;
+    for (int t = 1;; t = (t * 2 < max_threads) ? t * 2 : max_threads) {
+        wspool* pool = wspool_create(t);
+        if (!pool) { perror("wspool_create"); return EXIT_FAILURE; }
+
+        double bs = 1e30, bg = 1e30;
+        for (int r = 0; r < reps; ++r) {
+            memset(out, 0, n * sizeof(long long));
+            double t0 = now_sec();
+            if (scan_int(pool, in, out, n, SCAN_INCLUSIVE) != 0) { perror("scan_int"); return EXIT_FAILURE; }
+            double t1 = now_sec();
+            if (segmented_sum_int(pool, in, n, offsets, m, seg_out) != 0) { perror("segmented_sum_int"); return EXIT_FAILURE; }
+            double t2 = now_sec();
+            if (t1 - t0 < bs) bs = t1 - t0;
+            if (t2 - t1 < bg) bg = t2 - t1;
+        }
+        int ok = memcmp(out, ref, n * sizeof(long long)) == 0
+              && memcmp(seg_out, seg_ref, m * sizeof(long long)) == 0;
+
+        // Exclusive scan is checked once per thread count (not timed).
+        scan_int(pool, in, out, n, SCAN_EXCLUSIVE);
+        for (size_t i = 0; i < n && ok; ++i) ok = out[i] == (i ? ref[i - 1] : 0);
+
+        printf("%-8d %12.2f %8.2f %12.2f %8.2f%s\n", t, bs * 1e3, best_scan / bs,
+               bg * 1e3, best_seg / bg, ok ? "" : "  MISMATCH");
+        failures += !ok;
+        wspool_destroy(pool);
+        if (t == max_threads) break;
+    }
+
+    free(in); free(ref); free(out); free(offsets); free(seg_ref); free(seg_out);
+    return failures ? EXIT_FAILURE : 0;
+}
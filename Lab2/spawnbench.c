@@ -0,0 +1,347 @@
+// spawnbench.c
+// What does it cost to create a process or thread? Times create + exit + reap
+// for fork, vfork, posix_spawn, clone with several flag sets, clone3 and
+// pthread_create, while sweeping the parent's resident memory and the number
+// of threads creating concurrently.
+//
+// Build:   gcc -Wall -Wextra -std=c11 -O2 -pthread -o spawnbench spawnbench.c
+// Run:     ./spawnbench                              # default sweep (up to 1 GB touched)
+//          ./spawnbench -R 1M,64M,1G,4G -p 1,4,16    # RSS x parallelism
+//          ./spawnbench -m fork,vfork,pthread -T 500 # some methods, 0.5 s per cell
+//
+// Flags:
+//   -m <list>    methods (default: all). fork, vfork, posix_spawn, clone,
+//                clone-vm, clone-vm-vfork, clone-shared, clone3, pthread
+//   -R <list>    parent RSS to touch before each group, K/M/G suffixes (default 1M,64M,1G)
+//   -p <list>    numbers of threads creating concurrently (default 1,<cores>)
+//   -n <int>     maximum creations per thread and cell (default 2000)
+//   -T <int>     time budget per cell in ms (default 1000); at least 5 creations run
+//   -e <path>    program run by posix_spawn (default /bin/true)
+//
+// One cell is (RSS, method, parallelism). Every creating thread records the
+// latency of each create+exit+reap round trip; the table shows the median and
+// 99th percentile of all of them and the total creations per second of wall
+// time. The child of every method exits at once, so for posix_spawn the cost
+// includes exec'ing the program.
+//
+// The clone flag sets:
+//   clone           SIGCHLD only: a fork done through clone()
+//   clone-vm        CLONE_VM: shares the address space, so no page tables are copied
+//   clone-vm-vfork  CLONE_VM | CLONE_VFORK: as vfork, the caller sleeps until the child exits
+//   clone-shared    CLONE_VM | CLONE_FS | CLONE_FILES | CLONE_SIGHAND: a thread without CLONE_THREAD
+//   clone3          clone3() with no flags (fork semantics); "unsupported" on kernels before 5.3
+
+#define _GNU_SOURCE       // clone(), vfork(), CLONE_* flags
+#include <errno.h>
+#include <pthread.h>
+#include <sched.h>
+#include <signal.h>
+#include <spawn.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+#ifdef SYS_clone3
+#include <linux/sched.h>  // struct clone_args
+#endif
+
+extern char** environ;
+
+#define CHILD_STACK (64 * 1024)
+
+static const char* spawn_path = "/bin/true";
+
+static long long now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static int reap(pid_t p) {
+    int status;
+    while (waitpid(p, &status, 0) < 0) {
+        if (errno != EINTR) return -1;
+    }
+    return WIFEXITED(status) && WEXITSTATUS(status) == 0 ? 0 : -1;
+}
+
+// ---------- Methods: each creates one child, lets it exit, and reaps it ----------
+// `stack` is a private CHILD_STACK-byte region of the calling thread.
+// Return 0, or -1 with errno set (ENOSYS marks the method unsupported).
+
+static int do_fork(void* stack) {
+    (void)stack;
+    pid_t p = fork();
+    if (p < 0) return -1;
+    if (p == 0) _exit(0);
+    return reap(p);
+}
+
+static int do_vfork(void* stack) {
+    (void)stack;
+    pid_t p = vfork();
+    if (p < 0) return -1;
+    if (p == 0) _exit(0);
+    return reap(p);
+}
+
+static int do_posix_spawn(void* stack) {
+    (void)stack;
+    char* argv[] = { (char*)spawn_path, NULL };
+    pid_t p;
+    int rc = posix_spawn(&p, spawn_path, NULL, NULL, argv, environ);
+    if (rc != 0) { errno = rc; return -1; }
+    return reap(p);
+}
+
+static int clone_child(void* arg) { (void)arg; return 0; }
+
+static int clone_with(void* stack, int flags) {
+    pid_t p = clone(clone_child, (char*)stack + CHILD_STACK, flags | SIGCHLD, NULL);
+    if (p < 0) return -1;
+    return reap(p);
+}
+
+static int do_clone(void* stack)          { return clone_with(stack, 0); }
+static int do_clone_vm(void* stack)       { return clone_with(stack, CLONE_VM); }
+static int do_clone_vm_vfork(void* stack) { return clone_with(stack, CLONE_VM | CLONE_VFORK); }
+static int do_clone_shared(void* stack)   { return clone_with(stack, CLONE_VM | CLONE_FS | CLONE_FILES | CLONE_SIGHAND); }
+
+static int do_clone3(void* stack) {
+    (void)stack;
+#ifdef SYS_clone3
+    struct clone_args args;
+    memset(&args, 0, sizeof(args));
+    args.exit_signal = SIGCHLD;
+    long p = syscall(SYS_clone3, &args, sizeof(args));
+    if (p < 0) return -1;
+    if (p == 0) _exit(0);
+    return reap((pid_t)p);
+#else
+    errno = ENOSYS;
+    return -1;
+#endif
+}
+
+static void* thread_child(void* arg) { return arg; }
+
+static int do_pthread(void* stack) {
+    (void)stack;
+    pthread_t t;
+    int rc = pthread_create(&t, NULL, thread_child, NULL);
+    if (rc != 0) { errno = rc; return -1; }
+    return pthread_join(t, NULL) == 0 ? 0 : -1;
+}
+
+typedef struct {
+    const char* name;
+    int (*create)(void* stack);
+} method;
+
+static const method methods[] = {
+    { "fork",           do_fork },
+    { "vfork",          do_vfork },
+    { "posix_spawn",    do_posix_spawn },
+    { "clone",          do_clone },
+    { "clone-vm",       do_clone_vm },
+    { "clone-vm-vfork", do_clone_vm_vfork },
+    { "clone-shared",   do_clone_shared },
+    { "clone3",         do_clone3 },
+    { "pthread",        do_pthread },
+};
+#define NMETHODS ((int)(sizeof(methods) / sizeof(methods[0])))
+
+// ---------- One cell: `par` threads creating concurrently ----------
+
+typedef struct {
+    const method* m;
+    pthread_barrier_t* start;
+    long long deadline_ns;
+    int max_samples;
+    long long* lat;          // this worker's latencies (ns)
+    int count;
+    int err;                 // errno of the first failure, 0 if none
+} worker;
+
+static void* worker_main(void* varg) {
+    worker* w = (worker*)varg;
+    void* stack = malloc(CHILD_STACK);
+    pthread_barrier_wait(w->start);   // even without a stack, or the others would hang
+    if (!stack) { w->err = ENOMEM; return NULL; }
+
+    while (w->count < w->max_samples) {
+        long long t0 = now_ns();
+        if (w->m->create(stack) != 0) { w->err = errno ? errno : EIO; break; }
+        long long t1 = now_ns();
+        w->lat[w->count++] = t1 - t0;
+        if (w->count >= 5 && t1 >= w->deadline_ns) break;
+    }
+    free(stack);
+    return NULL;
+}
+
+static int cmp_ll(const void* a, const void* b) {
+    long long x = *(const long long*)a, y = *(const long long*)b;
+    return (x > y) - (x < y);
+}
+
+static void run_cell(const char* rss_label, const method* m, int par, int max_samples, int budget_ms) {
+    worker* ws = calloc((size_t)par, sizeof(worker));
+    pthread_t* tids = calloc((size_t)par, sizeof(pthread_t));
+    long long* lat = malloc(sizeof(long long) * (size_t)par * (size_t)max_samples);
+    if (!ws || !tids || !lat) { perror("malloc"); exit(EXIT_FAILURE); }
+
+    pthread_barrier_t start;
+    pthread_barrier_init(&start, NULL, (unsigned)par + 1);
+    for (int i = 0; i < par; ++i) {
+        ws[i].m = m;
+        ws[i].start = &start;
+        ws[i].max_samples = max_samples;
+        ws[i].lat = lat + (size_t)i * (size_t)max_samples;
+        if (pthread_create(&tids[i], NULL, worker_main, &ws[i]) != 0) {
+            perror("pthread_create");
+            exit(EXIT_FAILURE);
+        }
+    }
+    // Workers read the deadline only after the barrier, so set it just before.
+    long long t0 = now_ns();
+    long long deadline = t0 + (long long)budget_ms * 1000000LL;
+    for (int i = 0; i < par; ++i) ws[i].deadline_ns = deadline;
+    pthread_barrier_wait(&start);
+    for (int i = 0; i < par; ++i) pthread_join(tids[i], NULL);
+    double wall = (double)(now_ns() - t0) / 1e9;
+    pthread_barrier_destroy(&start);
+
+    // Pack every worker's samples together and take percentiles of the lot.
+    size_t total = 0;
+    int err = 0;
+    for (int i = 0; i < par; ++i) {
+        memmove(lat + total, ws[i].lat, sizeof(long long) * (size_t)ws[i].count);
+        total += (size_t)ws[i].count;
+        if (ws[i].err && !err) err = ws[i].err;
+    }
+
+    if (total == 0) {
+        printf("%8s %-15s %4d %9s  %s\n", rss_label, m->name, par, "-",
+               err == ENOSYS ? "unsupported" : strerror(err));
+    } else {
+        qsort(lat, total, sizeof(long long), cmp_ll);
+        double p50 = (double)lat[total / 2] / 1e3;
+        double p99 = (double)lat[(total * 99) / 100 < total ? (total * 99) / 100 : total - 1] / 1e3;
+        printf("%8s %-15s %4d %9zu %10.1f %10.1f %12.0f%s%s\n", rss_label, m->name, par, total,
+               p50, p99, (double)total / wall, err ? "  error: " : "", err ? strerror(err) : "");
+    }
+    fflush(stdout);
+    free(lat);
+    free(tids);
+    free(ws);
+}
+
+// ---------- Option parsing ----------
+
+static size_t parse_size(const char* s, char** end) {
+    unsigned long long v = strtoull(s, end, 10);
+    switch (**end) {
+        case 'G': case 'g': v <<= 30; ++*end; break;
+        case 'M': case 'm': v <<= 20; ++*end; break;
+        case 'K': case 'k': v <<= 10; ++*end; break;
+        default: break;
+    }
+    return (size_t)v;
+}
+
+static int find_method(const char* name, size_t len) {
+    for (int i = 0; i < NMETHODS; ++i) {
+        if (strlen(methods[i].name) == len && strncmp(methods[i].name, name, len) == 0) return i;
+    }
+    return -1;
+}
+
+int main(int argc, char** argv) {
+    const char* method_list = NULL;
+    const char* rss_list = "1M,64M,1G";
+    const char* par_list = NULL;
+    int max_samples = 2000, budget_ms = 1000;
+
+    int c;
+    while ((c = getopt(argc, argv, "m:R:p:n:T:e:h")) != -1) {
+        switch (c) {
+            case 'm': method_list = optarg; break;
+            case 'R': rss_list = optarg; break;
+            case 'p': par_list = optarg; break;
+            case 'n': max_samples = atoi(optarg); break;
+            case 'T': budget_ms = atoi(optarg); break;
+            case 'e': spawn_path = optarg; break;
+            default:
+                fprintf(stderr, "Usage: %s [-m methods] [-R rss_list] [-p par_list] [-n max] [-T ms] [-e path]\n", argv[0]);
+                return c == 'h' ? 0 : EXIT_FAILURE;
+        }
+    }
+    if (max_samples < 5) max_samples = 5;
+    if (budget_ms < 0) budget_ms = 0;
+
+    int selected[NMETHODS], nsel = 0;
+    if (!method_list) {
+        for (int i = 0; i < NMETHODS; ++i) selected[nsel++] = i;
+    } else {
+        for (const char* s = method_list; *s;) {
+            size_t len = strcspn(s, ",");
+            int m = find_method(s, len);
+            if (m < 0) { fprintf(stderr, "unknown method: %.*s\n", (int)len, s); return EXIT_FAILURE; }
+            if (nsel < NMETHODS) selected[nsel++] = m;
+            s += len;
+            if (*s == ',') ++s;
+        }
+    }
+
+    char default_par[32];
+    if (!par_list) {
+        long cores = sysconf(_SC_NPROCESSORS_ONLN);
+        if (cores > 1) snprintf(default_par, sizeof(default_par), "1,%ld", cores);
+        else snprintf(default_par, sizeof(default_par), "1");
+        par_list = default_par;
+    }
+
+    printf("%8s %-15s %4s %9s %10s %10s %12s\n", "rss", "method", "par", "samples", "p50 us", "p99 us", "per second");
+
+    for (const char* r = rss_list; *r;) {
+        char* end;
+        size_t rss = parse_size(r, &end);
+        char label[32];
+        snprintf(label, sizeof(label), "%.*s", (int)(end - r), r);
+
+        // Private anonymous memory, every page written, so fork has to copy
+        // page tables for all of it.
+        void* mem = NULL;
+        if (rss > 0) {
+            mem = mmap(NULL, rss, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (mem == MAP_FAILED) {
+                fprintf(stderr, "%s: mmap: %s, skipped\n", label, strerror(errno));
+                mem = NULL;
+            } else {
+                long page = sysconf(_SC_PAGESIZE);
+                for (size_t off = 0; off < rss; off += (size_t)page) ((volatile char*)mem)[off] = 1;
+            }
+        }
+
+        if (mem || rss == 0) {
+            for (const char* p = par_list; *p;) {
+                int par = atoi(p);
+                if (par > 0) {
+                    for (int i = 0; i < nsel; ++i) run_cell(label, &methods[selected[i]], par, max_samples, budget_ms);
+                }
+                p += strcspn(p, ",");
+                if (*p == ',') ++p;
+            }
+        }
+        if (mem) munmap(mem, rss);
+
+        r = end + strcspn(end, ",");
+        if (*r == ',') ++r;
+    }
+    return 0;
+}
@@ -0,0 +1,105 @@
+// stats.c
+// Pool drivers for the kernels in stats.h, one instantiation per element type.
+
+#define _POSIX_C_SOURCE 200809L
+#include "stats.h"
+
+#include <errno.h>
+#include <string.h>
+
+#define STATS_GRAIN (16 * STATS_BLOCK)
+
+#define STATS_DEFINE_DRIVER(T, ACC, NAME)                                           \
+    typedef struct {                                                                \
+        NAME##_result r;                                                            \
+        stats_hist h;                                                               \
+    } NAME##_acc;                                                                   \
+                                                                                    \
+    typedef struct {                                                                \
+        const T* a;                                                                 \
+        unsigned what;                                                              \
+        const stats_hist* spec;                                                     \
+    } NAME##_job;                                                                   \
+                                                                                    \
+    static void NAME##_init(void* vacc, void* varg) {                               \
+        NAME##_acc* s = (NAME##_acc*)vacc;                                          \
+        const NAME##_job* j = (const NAME##_job*)varg;                              \
+        memset(s, 0, sizeof(*s));                                                   \
+        if (j->what & STATS_HIST) {                                                 \
+            s->h.lo = j->spec->lo;                                                  \
+            s->h.hi = j->spec->hi;                                                  \
+            s->h.bins = j->spec->bins;                                              \
+        }                                                                           \
+    }                                                                               \
+                                                                                    \
+    /* One pass over [from, to): every requested kernel runs on each block */       \
+    static void NAME##_body(size_t from, size_t to, void* vacc, void* varg) {       \
+        NAME##_acc* s = (NAME##_acc*)vacc;                                          \
+        const NAME##_job* j = (const NAME##_job*)varg;                              \
+        for (size_t b = from; b < to; b += STATS_BLOCK) {                           \
+            size_t len = (to - b < STATS_BLOCK) ? to - b : STATS_BLOCK;             \
+            const T* p = j->a + b;                                                  \
+            if (j->what & (STATS_SUM | STATS_MOMENTS)) {                            \
+                ACC sum = NAME##_k_sum(p, len);                                     \
+                s->r.sum += sum;                                                    \
+                if (j->what & STATS_MOMENTS) {                                      \
+                    stats_moments m = NAME##_k_moments(p, len, sum);                \
+                    stats_moments_merge(&s->r.moments, &m);                         \
+                }                                                                   \
+            }                                                                       \
+            if (j->what & STATS_MINMAX) {                                           \
+                T mn, mx;                                                           \
+                NAME##_k_minmax(p, len, &mn, &mx);                                  \
+                if (s->r.count == 0 || mn < s->r.min) s->r.min = mn;                \
+                if (s->r.count == 0 || mx > s->r.max) s->r.max = mx;                \
+            }                                                                       \
+            if (j->what & STATS_HIST) NAME##_k_hist(p, len, &s->h);                 \
+            s->r.count += len;                                                      \
+        }                                                                           \
+    }                                                                               \
+                                                                                    \
+    static void NAME##_combine(void* vinto, const void* vfrom, void* varg) {        \
+        NAME##_acc* a = (NAME##_acc*)vinto;                                         \
+        const NAME##_acc* b = (const NAME##_acc*)vfrom;                             \
+        const NAME##_job* j = (const NAME##_job*)varg;                              \
+        if (b->r.count == 0) return;                                                \
+        a->r.sum += b->r.sum;                                                       \
+        if (a->r.count == 0 || b->r.min < a->r.min) a->r.min = b->r.min;            \
+        if (a->r.count == 0 || b->r.max > a->r.max) a->r.max = b->r.max;            \
+        stats_moments_merge(&a->r.moments, &b->r.moments);                          \
+        if (j->what & STATS_HIST) {                                                 \
+            for (size_t k = 0; k < a->h.bins; ++k) a->h.counts[k] += b->h.counts[k];\
+            a->h.below += b->h.below;                                               \
+            a->h.above += b->h.above;                                               \
+        }                                                                           \
+        a->r.count += b->r.count;                                                   \
+    }                                                                               \
+                                                                                    \
+    int NAME(wspool* pool, const T* a, size_t n, unsigned what, stats_hist* hist,   \
+             NAME##_result* out) {                                                  \
+        if ((what & STATS_HIST) &&                                                  \
+            (!hist || hist->bins < 1 || hist->bins > STATS_MAX_BINS ||              \
+             !(hist->hi > hist->lo))) {                                             \
+            errno = EINVAL;                                                         \
+            return -1;                                                              \
+        }                                                                           \
+        NAME##_job j = { a, what, hist };                                           \
+        NAME##_acc total;                                                           \
+        if (wspool_parallel_reduce(pool, n, STATS_GRAIN, sizeof(NAME##_acc),        \
+                                   NAME##_init, NAME##_body, NAME##_combine,        \
+                                   &j, &total) != 0) {                              \
+            return -1;                                                              \
+        }                                                                           \
+        *out = total.r;                                                             \
+        if (what & STATS_HIST) {                                                    \
+            memcpy(hist->counts, total.h.counts, sizeof(hist->counts));             \
+            hist->below = total.h.below;                                            \
+            hist->above = total.h.above;                                            \
+        }                                                                           \
+        return 0;                                                                   \
+    }
+
+STATS_DEFINE_DRIVER(int,       long long, stats_i32)
+STATS_DEFINE_DRIVER(long long, long long, stats_i64)
+STATS_DEFINE_DRIVER(float,     double,    stats_f32)
+STATS_DEFINE_DRIVER(double,    double,    stats_f64)
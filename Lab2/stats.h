@@ -0,0 +1,162 @@
+// stats.h
+// Compile-time specialized reduction kernels: sum, min/max, mean/variance and
+// fixed-bin histograms for int, long long, float and double arrays.
+//
+// STATS_DEFINE_KERNELS(T, ACC, NAME) stamps out static inline kernels for one
+// element type T (ACC is the sum accumulator type). Each kernel is a plain loop
+// over 8 independent lanes with the operator written out, so the compiler can
+// inline and vectorize it; nothing calls through a function pointer per element.
+//
+// stats_<NAME>() runs the kernels you ask for over a whole array in one pass on
+// a work-stealing pool: the array is walked in cache-sized blocks and every
+// requested kernel runs on a block while it is still in cache. Mean/variance use
+// per-block two-pass moments merged with the parallel Welford (Chan et al.)
+// update, so they stay accurate for large n. stats_compute() picks the right
+// stats_<NAME>() with _Generic.
+
+#ifndef STATS_H
+#define STATS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "wspool.h"
+
+#define STATS_LANES     8
+#define STATS_BLOCK     4096     // elements per cache-resident block
+#define STATS_MAX_BINS  256
+
+enum {
+    STATS_SUM     = 1u << 0,
+    STATS_MINMAX  = 1u << 1,
+    STATS_MOMENTS = 1u << 2,     // mean and variance
+    STATS_HIST    = 1u << 3,
+    STATS_ALL     = 0xFu
+};
+
+// Fixed-width histogram over [lo, hi); values outside go to below/above.
+typedef struct {
+    double lo, hi;
+    size_t bins;                 // 1 .. STATS_MAX_BINS
+    uint64_t counts[STATS_MAX_BINS];
+    uint64_t below, above;
+} stats_hist;
+
+// Welford state: mean and sum of squared deviations (m2) over count values.
+typedef struct {
+    size_t count;
+    double mean, m2;
+} stats_moments;
+
+static inline void stats_moments_merge(stats_moments* into, const stats_moments* b) {
+    if (b->count == 0) return;
+    if (into->count == 0) { *into = *b; return; }
+    double n = (double)(into->count + b->count);
+    double delta = b->mean - into->mean;
+    into->mean += delta * (double)b->count / n;
+    into->m2   += b->m2 + delta * delta * (double)into->count * (double)b->count / n;
+    into->count += b->count;
+}
+
+static inline double stats_variance(const stats_moments* m) {    // sample variance
+    return m->count > 1 ? m->m2 / (double)(m->count - 1) : 0.0;
+}
+
+#define STATS_DEFINE_KERNELS(T, ACC, NAME)                                          \
+    static inline ACC NAME##_sum(const T* a, size_t n) {                            \
+        ACC lane[STATS_LANES] = { 0 };                                              \
+        size_t i = 0;                                                               \
+        for (; i + STATS_LANES <= n; i += STATS_LANES)                              \
+            for (int l = 0; l < STATS_LANES; ++l) lane[l] += a[i + l];              \
+        ACC s = 0;                                                                  \
+        for (int l = 0; l < STATS_LANES; ++l) s += lane[l];                         \
+        for (; i < n; ++i) s += a[i];                                               \
+        return s;                                                                   \
+    }                                                                               \
+    /* n must be > 0 */                                                             \
+    static inline void NAME##_minmax(const T* a, size_t n, T* mn, T* mx) {          \
+        T lo[STATS_LANES], hi[STATS_LANES];                                         \
+        for (int l = 0; l < STATS_LANES; ++l) lo[l] = hi[l] = a[0];                 \
+        size_t i = 0;                                                               \
+        for (; i + STATS_LANES <= n; i += STATS_LANES)                              \
+            for (int l = 0; l < STATS_LANES; ++l) {                                 \
+                T v = a[i + l];                                                     \
+                lo[l] = v < lo[l] ? v : lo[l];                                      \
+                hi[l] = v > hi[l] ? v : hi[l];                                      \
+            }                                                                       \
+        for (; i < n; ++i) {                                                        \
+            lo[0] = a[i] < lo[0] ? a[i] : lo[0];                                    \
+            hi[0] = a[i] > hi[0] ? a[i] : hi[0];                                    \
+        }                                                                           \
+        for (int l = 1; l < STATS_LANES; ++l) {                                     \
+            lo[0] = lo[l] < lo[0] ? lo[l] : lo[0];                                  \
+            hi[0] = hi[l] > hi[0] ? hi[l] : hi[0];                                  \
+        }                                                                           \
+        *mn = lo[0];                                                                \
+        *mx = hi[0];                                                                \
+    }                                                                               \
+    /* Second pass over a cache-resident block whose sum is already known */        \
+    static inline stats_moments NAME##_moments(const T* a, size_t n, ACC sum) {     \
+        stats_moments m = { n, 0.0, 0.0 };                                          \
+        if (n == 0) return m;                                                       \
+        m.mean = (double)sum / (double)n;                                           \
+        double lane[STATS_LANES] = { 0 };                                           \
+        size_t i = 0;                                                               \
+        for (; i + STATS_LANES <= n; i += STATS_LANES)                              \
+            for (int l = 0; l < STATS_LANES; ++l) {                                 \
+                double d = (double)a[i + l] - m.mean;                               \
+                lane[l] += d * d;                                                   \
+            }                                                                       \
+        for (; i < n; ++i) {                                                        \
+            double d = (double)a[i] - m.mean;                                       \
+            lane[0] += d * d;                                                       \
+        }                                                                           \
+        for (int l = 0; l < STATS_LANES; ++l) m.m2 += lane[l];                      \
+        return m;                                                                   \
+    }                                                                               \
+    static inline void NAME##_hist(const T* a, size_t n, stats_hist* h) {           \
+        double scale = (double)h->bins / (h->hi - h->lo);                           \
+        for (size_t i = 0; i < n; ++i) {                                            \
+            double x = (double)a[i];                                                \
+            if (!(x >= h->lo)) { h->below++; continue; }  /* NaN counts as below */ \
+            if (x >= h->hi) { h->above++; continue; }                               \
+            size_t b = (size_t)((x - h->lo) * scale);                               \
+            h->counts[b < h->bins ? b : h->bins - 1]++;                             \
+        }                                                                           \
+    }
+
+STATS_DEFINE_KERNELS(int,       long long, stats_i32_k)
+STATS_DEFINE_KERNELS(long long, long long, stats_i64_k)
+STATS_DEFINE_KERNELS(float,     double,    stats_f32_k)
+STATS_DEFINE_KERNELS(double,    double,    stats_f64_k)
+
+// Result of one stats_<NAME>() call; only the fields asked for are filled in.
+#define STATS_DEFINE_RESULT(T, ACC, NAME)                                           \
+    typedef struct {                                                                \
+        size_t count;                                                               \
+        ACC sum;                                                                    \
+        T min, max;                                                                 \
+        stats_moments moments;                                                      \
+    } NAME##_result;
+
+STATS_DEFINE_RESULT(int,       long long, stats_i32)
+STATS_DEFINE_RESULT(long long, long long, stats_i64)
+STATS_DEFINE_RESULT(float,     double,    stats_f32)
+STATS_DEFINE_RESULT(double,    double,    stats_f64)
+
+// what: STATS_* mask. hist: required for STATS_HIST (lo, hi and bins set by the
+// caller; counts are overwritten). Returns 0, or -1 (errno set).
+int stats_i32(wspool* pool, const int* a, size_t n, unsigned what, stats_hist* hist, stats_i32_result* out);
+int stats_i64(wspool* pool, const long long* a, size_t n, unsigned what, stats_hist* hist, stats_i64_result* out);
+int stats_f32(wspool* pool, const float* a, size_t n, unsigned what, stats_hist* hist, stats_f32_result* out);
+int stats_f64(wspool* pool, const double* a, size_t n, unsigned what, stats_hist* hist, stats_f64_result* out);
+
+#define stats_compute(pool, a, n, what, hist, out)         \
+    _Generic((a),                                          \
+        int*: stats_i32, const int*: stats_i32,            \
+        long long*: stats_i64, const long long*: stats_i64,\
+        float*: stats_f32, const float*: stats_f32,        \
+        double*: stats_f64, const double*: stats_f64       \
+    )(pool, a, n, what, hist, out)
+
+#endif // STATS_H
@@ -0,0 +1,371 @@
+// sum_simd.c
+// SIMD summation kernels declared in sum_simd.h.
+//
+// Each kernel is compiled for its own ISA with __attribute__((target)), so the
+// file builds with plain -O2 and the best kernel is picked at startup from
+// CPUID (__builtin_cpu_supports). Every vector kernel keeps four independent
+// accumulators to hide add latency, then finishes the tail with scalar code.
+
+#define _POSIX_C_SOURCE 200809L
+#include "sum_simd.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define SUM_X86 1
+#include <immintrin.h>
+#endif
+
+typedef struct {
+    int64_t (*i32)(const int32_t*, size_t);
+    int64_t (*i64)(const int64_t*, size_t);
+    double  (*f32)(const float*, size_t);
+    double  (*f64)(const double*, size_t);
+} kernels;
+
+// ---------- Scalar reference ----------
+
+static int64_t i32_scalar(const int32_t* a, size_t n) {
+    int64_t s = 0;
+    for (size_t i = 0; i < n; ++i) s += a[i];
+    return s;
+}
+
+static int64_t i64_scalar(const int64_t* a, size_t n) {
+    // Wrap-around like the vector adds do, instead of signed-overflow UB.
+    uint64_t s = 0;
+    for (size_t i = 0; i < n; ++i) s += (uint64_t)a[i];
+    return (int64_t)s;
+}
+
+static double f32_scalar(const float* a, size_t n) {
+    double s = 0.0;
+    for (size_t i = 0; i < n; ++i) s += a[i];
+    return s;
+}
+
+static double f64_scalar(const double* a, size_t n) {
+    double s = 0.0;
+    for (size_t i = 0; i < n; ++i) s += a[i];
+    return s;
+}
+
+#ifdef SUM_X86
+
+// ---------- SSE2 ----------
+
+__attribute__((target("sse2")))
+static inline __m128i widen_lo_sse2(__m128i v) {
+    return _mm_unpacklo_epi32(v, _mm_srai_epi32(v, 31));
+}
+
+__attribute__((target("sse2")))
+static inline __m128i widen_hi_sse2(__m128i v) {
+    return _mm_unpackhi_epi32(v, _mm_srai_epi32(v, 31));
+}
+
+__attribute__((target("sse2")))
+static int64_t i32_sse2(const int32_t* a, size_t n) {
+    __m128i s0 = _mm_setzero_si128(), s1 = s0, s2 = s0, s3 = s0;
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m128i v0 = _mm_loadu_si128((const __m128i*)(a + i));
+        __m128i v1 = _mm_loadu_si128((const __m128i*)(a + i + 4));
+        s0 = _mm_add_epi64(s0, widen_lo_sse2(v0));
+        s1 = _mm_add_epi64(s1, widen_hi_sse2(v0));
+        s2 = _mm_add_epi64(s2, widen_lo_sse2(v1));
+        s3 = _mm_add_epi64(s3, widen_hi_sse2(v1));
+    }
+    __m128i s = _mm_add_epi64(_mm_add_epi64(s0, s1), _mm_add_epi64(s2, s3));
+    int64_t lanes[2];
+    _mm_storeu_si128((__m128i*)lanes, s);
+    return lanes[0] + lanes[1] + i32_scalar(a + i, n - i);
+}
+
+__attribute__((target("sse2")))
+static int64_t i64_sse2(const int64_t* a, size_t n) {
+    __m128i s0 = _mm_setzero_si128(), s1 = s0, s2 = s0, s3 = s0;
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        s0 = _mm_add_epi64(s0, _mm_loadu_si128((const __m128i*)(a + i)));
+        s1 = _mm_add_epi64(s1, _mm_loadu_si128((const __m128i*)(a + i + 2)));
+        s2 = _mm_add_epi64(s2, _mm_loadu_si128((const __m128i*)(a + i + 4)));
+        s3 = _mm_add_epi64(s3, _mm_loadu_si128((const __m128i*)(a + i + 6)));
+    }
+    __m128i s = _mm_add_epi64(_mm_add_epi64(s0, s1), _mm_add_epi64(s2, s3));
+    uint64_t lanes[2];
+    _mm_storeu_si128((__m128i*)lanes, s);
+    return (int64_t)(lanes[0] + lanes[1] + (uint64_t)i64_scalar(a + i, n - i));
+}
+
+__attribute__((target("sse2")))
+static double f32_sse2(const float* a, size_t n) {
+    __m128d s0 = _mm_setzero_pd(), s1 = s0, s2 = s0, s3 = s0;
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m128 v0 = _mm_loadu_ps(a + i);
+        __m128 v1 = _mm_loadu_ps(a + i + 4);
+        s0 = _mm_add_pd(s0, _mm_cvtps_pd(v0));
+        s1 = _mm_add_pd(s1, _mm_cvtps_pd(_mm_movehl_ps(v0, v0)));
+        s2 = _mm_add_pd(s2, _mm_cvtps_pd(v1));
+        s3 = _mm_add_pd(s3, _mm_cvtps_pd(_mm_movehl_ps(v1, v1)));
+    }
+    __m128d s = _mm_add_pd(_mm_add_pd(s0, s1), _mm_add_pd(s2, s3));
+    double lanes[2];
+    _mm_storeu_pd(lanes, s);
+    return lanes[0] + lanes[1] + f32_scalar(a + i, n - i);
+}
+
+__attribute__((target("sse2")))
+static double f64_sse2(const double* a, size_t n) {
+    __m128d s0 = _mm_setzero_pd(), s1 = s0, s2 = s0, s3 = s0;
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        s0 = _mm_add_pd(s0, _mm_loadu_pd(a + i));
+        s1 = _mm_add_pd(s1, _mm_loadu_pd(a + i + 2));
+        s2 = _mm_add_pd(s2, _mm_loadu_pd(a + i + 4));
+        s3 = _mm_add_pd(s3, _mm_loadu_pd(a + i + 6));
+    }
+    __m128d s = _mm_add_pd(_mm_add_pd(s0, s1), _mm_add_pd(s2, s3));
+    double lanes[2];
+    _mm_storeu_pd(lanes, s);
+    return lanes[0] + lanes[1] + f64_scalar(a + i, n - i);
+}
+
+// ---------- AVX2 ----------
+
+__attribute__((target("avx2")))
+static int64_t i32_avx2(const int32_t* a, size_t n) {
+    __m256i s0 = _mm256_setzero_si256(), s1 = s0, s2 = s0, s3 = s0;
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        s0 = _mm256_add_epi64(s0, _mm256_cvtepi32_epi64(_mm_loadu_si128((const __m128i*)(a + i))));
+        s1 = _mm256_add_epi64(s1, _mm256_cvtepi32_epi64(_mm_loadu_si128((const __m128i*)(a + i + 4))));
+        s2 = _mm256_add_epi64(s2, _mm256_cvtepi32_epi64(_mm_loadu_si128((const __m128i*)(a + i + 8))));
+        s3 = _mm256_add_epi64(s3, _mm256_cvtepi32_epi64(_mm_loadu_si128((const __m128i*)(a + i + 12))));
+    }
+    __m256i s = _mm256_add_epi64(_mm256_add_epi64(s0, s1), _mm256_add_epi64(s2, s3));
+    int64_t lanes[4];
+    _mm256_storeu_si256((__m256i*)lanes, s);
+    return lanes[0] + lanes[1] + lanes[2] + lanes[3] + i32_scalar(a + i, n - i);
+}
+
+__attribute__((target("avx2")))
+static int64_t i64_avx2(const int64_t* a, size_t n) {
+    __m256i s0 = _mm256_setzero_si256(), s1 = s0, s2 = s0, s3 = s0;
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        s0 = _mm256_add_epi64(s0, _mm256_loadu_si256((const __m256i*)(a + i)));
+        s1 = _mm256_add_epi64(s1, _mm256_loadu_si256((const __m256i*)(a + i + 4)));
+        s2 = _mm256_add_epi64(s2, _mm256_loadu_si256((const __m256i*)(a + i + 8)));
+        s3 = _mm256_add_epi64(s3, _mm256_loadu_si256((const __m256i*)(a + i + 12)));
+    }
+    __m256i s = _mm256_add_epi64(_mm256_add_epi64(s0, s1), _mm256_add_epi64(s2, s3));
+    uint64_t lanes[4];
+    _mm256_storeu_si256((__m256i*)lanes, s);
+    return (int64_t)(lanes[0] + lanes[1] + lanes[2] + lanes[3] + (uint64_t)i64_scalar(a + i, n - i));
+}
+
+__attribute__((target("avx2")))
+static double f32_avx2(const float* a, size_t n) {
+    __m256d s0 = _mm256_setzero_pd(), s1 = s0, s2 = s0, s3 = s0;
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        s0 = _mm256_add_pd(s0, _mm256_cvtps_pd(_mm_loadu_ps(a + i)));
+        s1 = _mm256_add_pd(s1, _mm256_cvtps_pd(_mm_loadu_ps(a + i + 4)));
+        s2 = _mm256_add_pd(s2, _mm256_cvtps_pd(_mm_loadu_ps(a + i + 8)));
+        s3 = _mm256_add_pd(s3, _mm256_cvtps_pd(_mm_loadu_ps(a + i + 12)));
+    }
+    __m256d s = _mm256_add_pd(_mm256_add_pd(s0, s1), _mm256_add_pd(s2, s3));
+    double lanes[4];
+    _mm256_storeu_pd(lanes, s);
+    return (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]) + f32_scalar(a + i, n - i);
+}
+
+__attribute__((target("avx2")))
+static double f64_avx2(const double* a, size_t n) {
+    __m256d s0 = _mm256_setzero_pd(), s1 = s0, s2 = s0, s3 = s0;
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        s0 = _mm256_add_pd(s0, _mm256_loadu_pd(a + i));
+        s1 = _mm256_add_pd(s1, _mm256_loadu_pd(a + i + 4));
+        s2 = _mm256_add_pd(s2, _mm256_loadu_pd(a + i + 8));
+        s3 = _mm256_add_pd(s3, _mm256_loadu_pd(a + i + 12));
+    }
+    __m256d s = _mm256_add_pd(_mm256_add_pd(s0, s1), _mm256_add_pd(s2, s3));
+    double lanes[4];
+    _mm256_storeu_pd(lanes, s);
+    return (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]) + f64_scalar(a + i, n - i);
+}
+
+// ---------- AVX-512F ----------
+
+__attribute__((target("avx512f")))
+static int64_t i32_avx512(const int32_t* a, size_t n) {
+    __m512i s0 = _mm512_setzero_si512(), s1 = s0, s2 = s0, s3 = s0;
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        s0 = _mm512_add_epi64(s0, _mm512_cvtepi32_epi64(_mm256_loadu_si256((const __m256i*)(a + i))));
+        s1 = _mm512_add_epi64(s1, _mm512_cvtepi32_epi64(_mm256_loadu_si256((const __m256i*)(a + i + 8))));
+        s2 = _mm512_add_epi64(s2, _mm512_cvtepi32_epi64(_mm256_loadu_si256((const __m256i*)(a + i + 16))));
+        s3 = _mm512_add_epi64(s3, _mm512_cvtepi32_epi64(_mm256_loadu_si256((const __m256i*)(a + i + 24))));
+    }
+    __m512i s = _mm512_add_epi64(_mm512_add_epi64(s0, s1), _mm512_add_epi64(s2, s3));
+    return _mm512_reduce_add_epi64(s) + i32_scalar(a + i, n - i);
+}
+
+__attribute__((target("avx512f")))
+static int64_t i64_avx512(const int64_t* a, size_t n) {
+    __m512i s0 = _mm512_setzero_si512(), s1 = s0, s2 = s0, s3 = s0;
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        s0 = _mm512_add_epi64(s0, _mm512_loadu_si512((const void*)(a + i)));
+        s1 = _mm512_add_epi64(s1, _mm512_loadu_si512((const void*)(a + i + 8)));
+        s2 = _mm512_add_epi64(s2, _mm512_loadu_si512((const void*)(a + i + 16)));
+        s3 = _mm512_add_epi64(s3, _mm512_loadu_si512((const void*)(a + i + 24)));
+    }
+    __m512i s = _mm512_add_epi64(_mm512_add_epi64(s0, s1), _mm512_add_epi64(s2, s3));
+    return (int64_t)((uint64_t)_mm512_reduce_add_epi64(s) + (uint64_t)i64_scalar(a + i, n - i));
+}
+
+__attribute__((target("avx512f")))
+static double f32_avx512(const float* a, size_t n) {
+    __m512d s0 = _mm512_setzero_pd(), s1 = s0, s2 = s0, s3 = s0;
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        s0 = _mm512_add_pd(s0, _mm512_cvtps_pd(_mm256_loadu_ps(a + i)));
+        s1 = _mm512_add_pd(s1, _mm512_cvtps_pd(_mm256_loadu_ps(a + i + 8)));
+        s2 = _mm512_add_pd(s2, _mm512_cvtps_pd(_mm256_loadu_ps(a + i + 16)));
+        s3 = _mm512_add_pd(s3, _mm512_cvtps_pd(_mm256_loadu_ps(a + i + 24)));
+    }
+    __m512d s = _mm512_add_pd(_mm512_add_pd(s0, s1), _mm512_add_pd(s2, s3));
+    return _mm512_reduce_add_pd(s) + f32_scalar(a + i, n - i);
+}
+
+__attribute__((target("avx512f")))
+static double f64_avx512(const double* a, size_t n) {
+    __m512d s0 = _mm512_setzero_pd(), s1 = s0, s2 = s0, s3 = s0;
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        s0 = _mm512_add_pd(s0, _mm512_loadu_pd(a + i));
+        s1 = _mm512_add_pd(s1, _mm512_loadu_pd(a + i + 8));
+        s2 = _mm512_add_pd(s2, _mm512_loadu_pd(a + i + 16));
+        s3 = _mm512_add_pd(s3, _mm512_loadu_pd(a + i + 24));
+    }
+    __m512d s = _mm512_add_pd(_mm512_add_pd(s0, s1), _mm512_add_pd(s2, s3));
+    return _mm512_reduce_add_pd(s) + f64_scalar(a + i, n - i);
+}
+
+#endif // SUM_X86
+
+// ---------- Dispatch ----------
+
+static const kernels table[SUM_LEVELS] = {
+    [SUM_SCALAR] = { i32_scalar, i64_scalar, f32_scalar, f64_scalar },
+#ifdef SUM_X86
+    [SUM_SSE2]   = { i32_sse2,   i64_sse2,   f32_sse2,   f64_sse2   },
+    [SUM_AVX2]   = { i32_avx2,   i64_avx2,   f32_avx2,   f64_avx2   },
+    [SUM_AVX512] = { i32_avx512, i64_avx512, f32_avx512, f64_avx512 },
+#endif
+};
+
+static sum_level detected = SUM_SCALAR;
+static sum_level current  = SUM_SCALAR;
+static kernels active = { i32_scalar, i64_scalar, f32_scalar, f64_scalar };
+
+// Runs before main(), so the sum_* functions never need a lazy-init check.
+__attribute__((constructor))
+static void sum_simd_init(void) {
+#ifdef SUM_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f"))   detected = SUM_AVX512;
+    else if (__builtin_cpu_supports("avx2")) detected = SUM_AVX2;
+    else if (__builtin_cpu_supports("sse2")) detected = SUM_SSE2;
+#endif
+    sum_simd_set_level(detected);
+}
+
+sum_level sum_simd_detect(void) { return detected; }
+sum_level sum_simd_level(void)  { return current; }
+
+sum_level sum_simd_set_level(sum_level level) {
+    if (level < SUM_SCALAR) level = SUM_SCALAR;
+    if (level > detected)   level = detected;
+    current = level;
+    active  = table[level];
+    return level;
+}
+
+const char* sum_simd_name(sum_level level) {
+    switch (level) {
+        case SUM_SCALAR: return "scalar";
+        case SUM_SSE2:   return "sse2";
+        case SUM_AVX2:   return "avx2";
+        case SUM_AVX512: return "avx512";
+        default:         return "?";
+    }
+}
+
+int64_t sum_i32(const int32_t* a, size_t n) { return active.i32(a, n); }
+int64_t sum_i64(const int64_t* a, size_t n) { return active.i64(a, n); }
+double  sum_f32(const float* a, size_t n)   { return active.f32(a, n); }
+double  sum_f64(const double* a, size_t n)  { return active.f64(a, n); }
+
+// ---------- Verification against the scalar path ----------
+
+int sum_simd_verify(void) {
+    enum { MAXN = 4099, OFFSETS = 3 };
+    static const size_t lengths[] = { 0, 1, 7, 15, 31, 33, 64, 1000, MAXN - OFFSETS };
+
+    int32_t* i32 = malloc((MAXN) * sizeof(int32_t));
+    int64_t* i64 = malloc((MAXN) * sizeof(int64_t));
+    float*   f32 = malloc((MAXN) * sizeof(float));
+    double*  f64 = malloc((MAXN) * sizeof(double));
+    if (!i32 || !i64 || !f32 || !f64) {
+        perror("malloc");
+        free(i32); free(i64); free(f32); free(f64);
+        return 1;
+    }
+
+    unsigned int rng = 12345u;
+    for (size_t i = 0; i < MAXN; ++i) {
+        // Full-range ints exercise sign extension in the widening kernels.
+        int32_t r = (int32_t)(((uint32_t)rand_r(&rng) << 16) ^ (uint32_t)rand_r(&rng));
+        i32[i] = r;
+        i64[i] = ((int64_t)r * (INT64_C(1) << 20)) ^ rand_r(&rng);   // multiply: << on a negative value is UB
+        f32[i] = (float)rand_r(&rng) / (float)RAND_MAX - 0.5f;
+        f64[i] = (double)rand_r(&rng) / (double)RAND_MAX - 0.5;
+    }
+
+    sum_level saved = current;
+    int failures = 0;
+
+    for (int lvl = SUM_SSE2; lvl <= (int)detected; ++lvl) {
+        int bad[4] = { 0, 0, 0, 0 };
+        for (size_t li = 0; li < sizeof(lengths) / sizeof(lengths[0]); ++li) {
+            for (size_t off = 0; off < OFFSETS; ++off) {
+                size_t n = lengths[li];
+                const kernels* k = &table[lvl];
+                if (k->i32(i32 + off, n) != i32_scalar(i32 + off, n)) bad[0]++;
+                if (k->i64(i64 + off, n) != i64_scalar(i64 + off, n)) bad[1]++;
+                // Different summation order: allow a small relative error.
+                double rf = f32_scalar(f32 + off, n), vf = k->f32(f32 + off, n);
+                double rd = f64_scalar(f64 + off, n), vd = k->f64(f64 + off, n);
+                if (fabs(vf - rf) > 1e-9 * (1.0 + (double)n)) bad[2]++;
+                if (fabs(vd - rd) > 1e-9 * (1.0 + (double)n)) bad[3]++;
+            }
+        }
+        static const char* types[4] = { "int32", "int64", "float", "double" };
+        for (int t = 0; t < 4; ++t) {
+            printf("%-7s %-7s %s\n", sum_simd_name((sum_level)lvl), types[t],
+                   bad[t] ? "MISMATCH" : "ok");
+            failures += bad[t];
+        }
+    }
+
+    sum_simd_set_level(saved);
+    free(i32); free(i64); free(f32); free(f64);
+    return failures;
+}
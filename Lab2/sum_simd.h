@@ -0,0 +1,45 @@
+// sum_simd.h
+// Vectorized array sums (SSE2 / AVX2 / AVX-512) with runtime CPU dispatch.
+//
+// Integer sums widen to 64 bits and are exact, so every level returns the same
+// value. Float sums accumulate in double; because the vector kernels add in a
+// different order than the scalar loop, float results may differ in the last
+// bits between levels.
+
+#ifndef SUM_SIMD_H
+#define SUM_SIMD_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+typedef enum {
+    SUM_SCALAR = 0,
+    SUM_SSE2,
+    SUM_AVX2,
+    SUM_AVX512,
+    SUM_LEVELS
+} sum_level;
+
+// Best level supported by this CPU (detected once via CPUID).
+sum_level sum_simd_detect(void);
+
+// Level currently used by the sum_* functions. Defaults to sum_simd_detect().
+sum_level sum_simd_level(void);
+
+// Force a level (e.g. for verification). Levels the CPU lacks are clamped down
+// to the best supported one; returns the level actually selected.
+sum_level sum_simd_set_level(sum_level level);
+
+const char* sum_simd_name(sum_level level);
+
+int64_t sum_i32(const int32_t* a, size_t n);
+int64_t sum_i64(const int64_t* a, size_t n);
+double  sum_f32(const float* a, size_t n);
+double  sum_f64(const double* a, size_t n);
+
+// Compare every supported level against the scalar path on random inputs of
+// several lengths/alignments. Prints one line per level/type to stdout and
+// returns the number of mismatches.
+int sum_simd_verify(void);
+
+#endif // SUM_SIMD_H
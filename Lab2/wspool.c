@@ -0,0 +1,292 @@
+// wspool.c
+// Implementation of the work-stealing pool declared in wspool.h.
+//
+// Deque: Chase-Lev with the C11 memory orderings from Le, Pop, Cohen and
+// Zappa Nardelli, "Correct and Efficient Work-Stealing for Weak Memory Models"
+// (PPoPP 2013). The owner pushes/takes at the bottom, thieves steal at the top.
+// Because ranges are split in halves, a deque never holds more than about
+// log2(n) entries, so a fixed-size buffer is enough; if it ever fills up the
+// owner simply stops splitting and runs the range itself.
+
+#define _POSIX_C_SOURCE 200809L
+#include "wspool.h"
+
+#include <errno.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define CACHE_LINE 64
+#define DEQUE_CAP  128   // power of two
+
+typedef struct {
+    atomic_size_t from, to;
+} task_slot;
+
+typedef struct {
+    _Alignas(CACHE_LINE) atomic_long top;      // thieves
+    _Alignas(CACHE_LINE) atomic_long bottom;   // owner
+    task_slot buf[DEQUE_CAP];
+    struct wspool* pool;
+    int id;
+    unsigned int rng;                          // victim selection, owner only
+} deque;
+
+struct wspool {
+    int size;
+    pthread_t* threads;        // size - 1 background workers
+    deque* deques;             // one per worker; deques[0] belongs to the caller
+
+    pthread_mutex_t m;
+    pthread_cond_t wake;       // workers: a new job (or shutdown) is available
+    pthread_cond_t done;       // caller: the last worker has left the job
+    unsigned long gen;         // job generation, bumped once per job
+    int active;                // workers currently inside a job
+    int shutdown;
+
+    // Current job, written under m before gen is bumped.
+    wspool_for_fn fn;
+    void* arg;
+    size_t grain;
+    _Alignas(CACHE_LINE) atomic_size_t remaining;   // elements not yet processed
+
+    void* scratch;             // parallel_reduce accumulators
+    size_t scratch_size;
+};
+
+// ---------- Chase-Lev deque ----------
+
+static int deque_push(deque* q, size_t from, size_t to) {
+    long b = atomic_load_explicit(&q->bottom, memory_order_relaxed);
+    long t = atomic_load_explicit(&q->top, memory_order_acquire);
+    if (b - t >= DEQUE_CAP) return 0;
+    task_slot* s = &q->buf[b & (DEQUE_CAP - 1)];
+    atomic_store_explicit(&s->from, from, memory_order_relaxed);
+    atomic_store_explicit(&s->to, to, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    atomic_store_explicit(&q->bottom, b + 1, memory_order_relaxed);
+    return 1;
+}
+
+static int deque_take(deque* q, size_t* from, size_t* to) {
+    long b = atomic_load_explicit(&q->bottom, memory_order_relaxed) - 1;
+    atomic_store_explicit(&q->bottom, b, memory_order_relaxed);
+    atomic_thread_fence(memory_order_seq_cst);
+    long t = atomic_load_explicit(&q->top, memory_order_relaxed);
+
+    if (t > b) {   // empty
+        atomic_store_explicit(&q->bottom, b + 1, memory_order_relaxed);
+        return 0;
+    }
+    task_slot* s = &q->buf[b & (DEQUE_CAP - 1)];
+    *from = atomic_load_explicit(&s->from, memory_order_relaxed);
+    *to   = atomic_load_explicit(&s->to, memory_order_relaxed);
+    if (t == b) {  // last element: race against thieves for it
+        int won = atomic_compare_exchange_strong_explicit(
+            &q->top, &t, t + 1, memory_order_seq_cst, memory_order_relaxed);
+        atomic_store_explicit(&q->bottom, b + 1, memory_order_relaxed);
+        return won;
+    }
+    return 1;
+}
+
+static int deque_steal(deque* q, size_t* from, size_t* to) {
+    long t = atomic_load_explicit(&q->top, memory_order_acquire);
+    atomic_thread_fence(memory_order_seq_cst);
+    long b = atomic_load_explicit(&q->bottom, memory_order_acquire);
+    if (t >= b) return 0;
+
+    task_slot* s = &q->buf[t & (DEQUE_CAP - 1)];
+    size_t f = atomic_load_explicit(&s->from, memory_order_relaxed);
+    size_t e = atomic_load_explicit(&s->to, memory_order_relaxed);
+    if (!atomic_compare_exchange_strong_explicit(
+            &q->top, &t, t + 1, memory_order_seq_cst, memory_order_relaxed)) {
+        return 0;  // lost the race; caller will try again
+    }
+    *from = f;
+    *to = e;
+    return 1;
+}
+
+// ---------- Job execution ----------
+
+// Split [from, to) down to grain, leaving the upper halves for thieves.
+static void run_range(wspool* p, deque* self, size_t from, size_t to) {
+    while (to - from > p->grain) {
+        size_t mid = from + (to - from) / 2;
+        if (!deque_push(self, mid, to)) break;
+        to = mid;
+    }
+    p->fn(from, to, self->id, p->arg);
+    atomic_fetch_sub_explicit(&p->remaining, to - from, memory_order_acq_rel);
+}
+
+static int steal_any(wspool* p, deque* self, size_t* from, size_t* to) {
+    int n = p->size;
+    int start = (int)(rand_r(&self->rng) % (unsigned)n);
+    for (int k = 0; k < n; ++k) {
+        int v = (start + k) % n;
+        if (v != self->id && deque_steal(&p->deques[v], from, to)) return 1;
+    }
+    return 0;
+}
+
+static void work(wspool* p, deque* self) {
+    size_t from, to;
+    while (atomic_load_explicit(&p->remaining, memory_order_acquire) > 0) {
+        if (deque_take(self, &from, &to) || steal_any(p, self, &from, &to)) {
+            run_range(p, self, from, to);
+        } else {
+            sched_yield();   // nothing to steal right now; let the owners run
+        }
+    }
+}
+
+static void* worker_main(void* varg) {
+    deque* self = (deque*)varg;
+    wspool* p = self->pool;
+    unsigned long seen = 0;
+
+    for (;;) {
+        pthread_mutex_lock(&p->m);
+        while (p->gen == seen && !p->shutdown) pthread_cond_wait(&p->wake, &p->m);
+        if (p->shutdown) { pthread_mutex_unlock(&p->m); break; }
+        seen = p->gen;
+        p->active++;
+        pthread_mutex_unlock(&p->m);
+
+        work(p, self);
+
+        pthread_mutex_lock(&p->m);
+        if (--p->active == 0) pthread_cond_signal(&p->done);
+        pthread_mutex_unlock(&p->m);
+    }
+    return NULL;
+}
+
+// ---------- Public API ----------
+
+wspool* wspool_create(int nthreads) {
+    if (nthreads <= 0) {
+        long n = sysconf(_SC_NPROCESSORS_ONLN);
+        nthreads = n < 1 ? 1 : (int)n;
+    }
+
+    wspool* p = calloc(1, sizeof(*p));
+    if (!p) return NULL;
+    p->size = nthreads;
+    p->deques = aligned_alloc(CACHE_LINE, sizeof(deque) * (size_t)nthreads);
+    p->threads = malloc(sizeof(pthread_t) * (size_t)nthreads);
+    if (!p->deques || !p->threads) {
+        free(p->deques); free(p->threads); free(p);
+        errno = ENOMEM;
+        return NULL;
+    }
+    memset(p->deques, 0, sizeof(deque) * (size_t)nthreads);
+    for (int i = 0; i < nthreads; ++i) {
+        p->deques[i].pool = p;
+        p->deques[i].id = i;
+        p->deques[i].rng = 0x9e3779b9u * (unsigned)(i + 1);
+    }
+    pthread_mutex_init(&p->m, NULL);
+    pthread_cond_init(&p->wake, NULL);
+    pthread_cond_init(&p->done, NULL);
+
+    for (int i = 1; i < nthreads; ++i) {
+        int err = pthread_create(&p->threads[i], NULL, worker_main, &p->deques[i]);
+        if (err != 0) {
+            p->size = i;          // only join what was started
+            wspool_destroy(p);
+            errno = err;
+            return NULL;
+        }
+    }
+    return p;
+}
+
+void wspool_destroy(wspool* p) {
+    if (!p) return;
+    pthread_mutex_lock(&p->m);
+    p->shutdown = 1;
+    pthread_cond_broadcast(&p->wake);
+    pthread_mutex_unlock(&p->m);
+    for (int i = 1; i < p->size; ++i) pthread_join(p->threads[i], NULL);
+
+    pthread_mutex_destroy(&p->m);
+    pthread_cond_destroy(&p->wake);
+    pthread_cond_destroy(&p->done);
+    free(p->scratch);
+    free(p->deques);
+    free(p->threads);
+    free(p);
+}
+
+int wspool_size(const wspool* p) {
+    return p->size;
+}
+
+void wspool_parallel_for(wspool* p, size_t n, size_t grain, wspool_for_fn fn, void* arg) {
+    if (n == 0) return;
+    if (grain == 0) grain = n / (8 * (size_t)p->size);
+    if (grain == 0) grain = 1;
+    if (p->size == 1 || n <= grain) {
+        fn(0, n, 0, arg);
+        return;
+    }
+
+    deque* self = &p->deques[0];
+    pthread_mutex_lock(&p->m);
+    p->fn = fn;
+    p->arg = arg;
+    p->grain = grain;
+    atomic_store_explicit(&p->remaining, n, memory_order_relaxed);
+    deque_push(self, 0, n);
+    p->gen++;
+    pthread_cond_broadcast(&p->wake);
+    pthread_mutex_unlock(&p->m);
+
+    work(p, self);
+
+    // All elements are done; wait until no worker still references the job.
+    pthread_mutex_lock(&p->m);
+    while (p->active > 0) pthread_cond_wait(&p->done, &p->m);
+    pthread_mutex_unlock(&p->m);
+}
+
+typedef struct {
+    wspool_reduce_fn body;
+    void* arg;
+    char* accs;
+    size_t stride;
+} reduce_job;
+
+static void reduce_body(size_t from, size_t to, int worker, void* varg) {
+    reduce_job* j = (reduce_job*)varg;
+    j->body(from, to, j->accs + (size_t)worker * j->stride, j->arg);
+}
+
+int wspool_parallel_reduce(wspool* p, size_t n, size_t grain, size_t acc_size,
+                           wspool_init_fn init, wspool_reduce_fn body,
+                           wspool_combine_fn combine, void* arg, void* out) {
+    size_t stride = (acc_size + CACHE_LINE - 1) / CACHE_LINE * CACHE_LINE;
+    size_t need = stride * (size_t)p->size;
+    if (need > p->scratch_size) {
+        void* s = aligned_alloc(CACHE_LINE, need);
+        if (!s) { errno = ENOMEM; return -1; }
+        free(p->scratch);
+        p->scratch = s;
+        p->scratch_size = need;
+    }
+
+    reduce_job j = { body, arg, (char*)p->scratch, stride };
+    for (int w = 0; w < p->size; ++w) init(j.accs + (size_t)w * stride, arg);
+
+    wspool_parallel_for(p, n, grain, reduce_body, &j);
+
+    init(out, arg);
+    for (int w = 0; w < p->size; ++w) combine(out, j.accs + (size_t)w * stride, arg);
+    return 0;
+}
@@ -0,0 +1,49 @@
+// wspool.h
+// Persistent work-stealing thread pool with parallel_for / parallel_reduce.
+//
+// The pool owns T-1 worker threads that sleep between jobs; the calling thread
+// takes part as worker 0, so a pool of size T runs T-way parallel. Each worker
+// has a Chase-Lev deque of index ranges. A worker splits the range it holds in
+// half, pushes the upper half on its own deque and keeps the lower half, until
+// the range is at most `grain` long; idle workers steal the oldest (largest)
+// ranges from other deques. Skewed work therefore balances itself without any
+// up-front partitioning, and repeated jobs pay no thread creation cost.
+//
+// Jobs on one pool must not overlap: call parallel_for/reduce from one thread
+// at a time and not from inside a body.
+
+#ifndef WSPOOL_H
+#define WSPOOL_H
+
+#include <stddef.h>
+
+typedef struct wspool wspool;
+
+// Body of a parallel_for: process [from, to). `worker` is in [0, wspool_size())
+// and is stable for the duration of the call, so it can index per-worker data.
+typedef void (*wspool_for_fn)(size_t from, size_t to, int worker, void* arg);
+
+// Body of a parallel_reduce: fold [from, to) into this worker's accumulator.
+typedef void (*wspool_reduce_fn)(size_t from, size_t to, void* acc, void* arg);
+// Set an accumulator to the identity value.
+typedef void (*wspool_init_fn)(void* acc, void* arg);
+// into = into (op) from. Which worker handled which range is not fixed, so
+// the operator must be associative and commutative.
+typedef void (*wspool_combine_fn)(void* into, const void* from, void* arg);
+
+// nthreads <= 0 means "number of online cores". Returns NULL on failure (errno set).
+wspool* wspool_create(int nthreads);
+void wspool_destroy(wspool* pool);
+int wspool_size(const wspool* pool);
+
+// Run fn over [0, n) in ranges of at most `grain` elements (0: n / (8 * size)).
+void wspool_parallel_for(wspool* pool, size_t n, size_t grain, wspool_for_fn fn, void* arg);
+
+// Reduce [0, n) into *out (acc_size bytes). Every worker gets its own
+// cache-line aligned accumulator; they are combined into *out at the end.
+// Returns 0 on success, -1 if scratch memory could not be allocated.
+int wspool_parallel_reduce(wspool* pool, size_t n, size_t grain, size_t acc_size,
+                           wspool_init_fn init, wspool_reduce_fn body,
+                           wspool_combine_fn combine, void* arg, void* out);
+
+#endif // WSPOOL_H
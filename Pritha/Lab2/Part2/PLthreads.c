@@ -1,69 +1,70 @@
-#include <pthread.h>
+// Build: gcc -O2 -pthread -I../../../Lab2 -o PLthreads PLthreads.c ../../../Lab2/wspool.c
+// Usage: ./PLthreads [number_of_threads]   (default 2)
+//
+// The threads come from the work-stealing pool in Lab2/wspool.c: they are
+// created once, and each pool worker adds the ranges it processes into its
+// own padded slot.
+
 #include <stdio.h>
 #include <stdlib.h>
 
+#include "wspool.h"
+
 #define SIZE 20
+#define CACHE_LINE 64
 
 int numbers[SIZE] = {1,2,3,4,5,6,7,8,9,10,11,12,13,14,15,16,17,18,19,20};
 
-// Partial sums for each thread
-int partial_sum1 = 0;
-int partial_sum2 = 0;
-
-// Structure to pass start and end to threads
+// One result slot per thread, padded to a full cache line so two threads
+// never write to the same line (no false sharing)
 typedef struct {
-    int from_index;
-    int to_index;
-} parameters;
+    _Alignas(CACHE_LINE) int sum;
+} partial_slot;
 
-// Thread function
-void *runner(void *param) {
-    parameters *data = (parameters *) param;
+partial_slot *partial_sums;
+
+// Pool body: sum numbers[from .. to-1] into the calling worker's slot
+void runner(size_t from, size_t to, int worker, void *arg) {
+    (void) arg;
     int local_sum = 0;
 
     // Calculating local sum for sublist
-    for (int i = data->from_index; i <= data->to_index; i++) {
+    for (size_t i = from; i < to; i++) {
         local_sum += numbers[i];
     }
 
-    // Storing local sum in each partial sum
-    if (data->from_index == 0)
-        partial_sum1 = local_sum;
-    else
-        partial_sum2 = local_sum;
-
-    free(data); // Free the dynamically allocated memory
-    pthread_exit(0);
+    // A worker may get several ranges, so add instead of overwrite
+    partial_sums[worker].sum += local_sum;
 }
 
-int main() {
-    pthread_t tid1, tid2;       
-    pthread_attr_t attr;         
-
-    pthread_attr_init(&attr);    // Initialize default attributes
-
-    // Thread 1 parameters
-    parameters *data1 = (parameters *) malloc(sizeof(parameters));
-    data1->from_index = 0;
-    data1->to_index = (SIZE / 2) - 1;
-
-    // Thread 2 parameters
-    parameters *data2 = (parameters *) malloc(sizeof(parameters));
-    data2->from_index = SIZE / 2;
-    data2->to_index = SIZE - 1;
-
-    // Creating threads
-    pthread_create(&tid1, &attr, runner, data1);
-    pthread_create(&tid2, &attr, runner, data2);
+int main(int argc, char *argv[]) {
+    int num_threads = 2;
+    if (argc > 1) num_threads = atoi(argv[1]);
+    if (num_threads < 1) num_threads = 1;
+    if (num_threads > SIZE) num_threads = SIZE;
+
+    wspool *pool = wspool_create(num_threads);
+    partial_sums = aligned_alloc(CACHE_LINE, num_threads * sizeof(partial_slot));
+    if (!pool || !partial_sums) {
+        perror("wspool_create");
+        return 1;
+    }
+    for (int i = 0; i < num_threads; i++) {
+        partial_sums[i].sum = 0;
+    }
 
-    // Waiting for threads to finish
-    pthread_join(tid1, NULL);
-    pthread_join(tid2, NULL);
+    // Split the list into ranges of about SIZE/N elements; idle workers steal
+    wspool_parallel_for(pool, SIZE, SIZE / num_threads, runner, NULL);
 
     // Main thread = total sum
-    int sum = partial_sum1 + partial_sum2;
+    int sum = 0;
+    for (int i = 0; i < num_threads; i++) {
+        sum += partial_sums[i].sum;
+    }
 
     printf("Sum of numbers in the list is: %d\n", sum);
 
+    free(partial_sums);
+    wspool_destroy(pool);
     return 0;
 }
@@ -1,14 +1,22 @@
 #include <pthread.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #define SIZE 20
+#define CACHE_LINE 64
 
 int numbers[SIZE];          
-int partial_sum1 = 0;       
-int partial_sum2 = 0;       
 
+// Per-thread result slot, one cache line each (avoids false sharing)
 typedef struct {
+    _Alignas(CACHE_LINE) int sum;
+} partial_slot;
+
+partial_slot *partial_sums;
+
+typedef struct {
+    int id;
     int from_index;
     int to_index;
 } parameters;
@@ -24,52 +32,66 @@ void *runner(void *param) {
     }
 
     
-    if (data->from_index == 0)
-        partial_sum1 = local_sum;
-    else
-        partial_sum2 = local_sum;
+    partial_sums[data->id].sum = local_sum;
 
     free(data);            
     pthread_exit(0);
 }
 
+// Usage: ./PLthreads_02 [-t number_of_threads] n1 n2 ... n20
 int main(int argc, char *argv[]) {
-    if (argc != SIZE + 1) {
+    int num_threads = 2;
+    int first = 1;
+
+    if (argc > 2 && strcmp(argv[1], "-t") == 0) {
+        num_threads = atoi(argv[2]);
+        first = 3;
+    }
+    if (num_threads < 1) num_threads = 1;
+    if (num_threads > SIZE) num_threads = SIZE;
+
+    if (argc - first != SIZE) {
         printf("Please provide %d numbers as input.\n", SIZE);
         return 1;
     }
 
     
     for (int i = 0; i < SIZE; i++) {
-        numbers[i] = atoi(argv[i + 1]);
+        numbers[i] = atoi(argv[first + i]);
     }
 
-    pthread_t tid1, tid2;
+    pthread_t *tids = malloc(num_threads * sizeof(pthread_t));
+    partial_sums = aligned_alloc(CACHE_LINE, num_threads * sizeof(partial_slot));
+    if (!tids || !partial_sums) {
+        perror("malloc");
+        return 1;
+    }
     pthread_attr_t attr;
 
     pthread_attr_init(&attr);    
 
     
-    parameters *data1 = (parameters *) malloc(sizeof(parameters));
-    data1->from_index = 0;
-    data1->to_index = (SIZE / 2) - 1;
-
-    
-    parameters *data2 = (parameters *) malloc(sizeof(parameters));
-    data2->from_index = SIZE / 2;
-    data2->to_index = SIZE - 1;
-
-    
-    pthread_create(&tid1, &attr, runner, data1);
-    pthread_create(&tid2, &attr, runner, data2);
+    for (int i = 0; i < num_threads; i++) {
+        parameters *data = (parameters *) malloc(sizeof(parameters));
+        data->id = i;
+        data->from_index = SIZE * i / num_threads;
+        data->to_index = SIZE * (i + 1) / num_threads - 1;
+        pthread_create(&tids[i], &attr, runner, data);
+    }
 
     
-    pthread_join(tid1, NULL);
-    pthread_join(tid2, NULL);
+    for (int i = 0; i < num_threads; i++) {
+        pthread_join(tids[i], NULL);
+    }
 
     
-    int sum = partial_sum1 + partial_sum2;
+    int sum = 0;
+    for (int i = 0; i < num_threads; i++) {
+        sum += partial_sums[i].sum;
+    }
     printf("Sum of numbers in the list is: %d\n", sum);
 
+    free(partial_sums);
+    free(tids);
     return 0;
 }
@@ -0,0 +1,97 @@
+// false_sharing.c
+// Benchmark: per-thread result slots packed next to each other (like the old
+// partial_sum1/partial_sum2 globals) vs. padded to one cache line per thread.
+//
+// Every thread repeatedly adds numbers into its own slot. With the packed
+// layout the slots share a cache line, so each write steals the line from
+// the other cores even though no data is actually shared.
+//
+// Build: gcc -O2 -pthread -o false_sharing false_sharing.c
+// Run:   ./false_sharing [threads] [iterations_per_thread]   (default 4, 100000000)
+
+#define _POSIX_C_SOURCE 200809L
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define CACHE_LINE 64
+
+typedef struct {
+    long long sum;
+} packed_slot;
+
+typedef struct {
+    _Alignas(CACHE_LINE) long long sum;
+} padded_slot;
+
+packed_slot *packed;
+padded_slot *padded;
+long iterations;
+
+typedef struct {
+    int id;
+    int use_padded;
+} parameters;
+
+void *runner(void *param) {
+    parameters *data = (parameters *) param;
+    // volatile forces a store to the slot on every iteration, which is what
+    // a thread accumulating straight into a shared global does
+    volatile long long *slot = data->use_padded ? &padded[data->id].sum
+                                                : &packed[data->id].sum;
+    for (long i = 0; i < iterations; i++) {
+        *slot += i & 7;
+    }
+    return NULL;
+}
+
+double run(int num_threads, int use_padded) {
+    pthread_t *tids = malloc(num_threads * sizeof(pthread_t));
+    parameters *params = malloc(num_threads * sizeof(parameters));
+    struct timespec t0, t1;
+
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    for (int i = 0; i < num_threads; i++) {
+        params[i].id = i;
+        params[i].use_padded = use_padded;
+        pthread_create(&tids[i], NULL, runner, &params[i]);
+    }
+    for (int i = 0; i < num_threads; i++) {
+        pthread_join(tids[i], NULL);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+
+    free(params);
+    free(tids);
+    return (t1.tv_sec - t0.tv_sec) * 1e3 + (t1.tv_nsec - t0.tv_nsec) / 1e6;
+}
+
+int main(int argc, char *argv[]) {
+    int num_threads = argc > 1 ? atoi(argv[1]) : 4;
+    iterations = argc > 2 ? atol(argv[2]) : 100000000L;
+    if (num_threads < 1) num_threads = 1;
+
+    packed = aligned_alloc(CACHE_LINE, ((num_threads * sizeof(packed_slot) + CACHE_LINE - 1) / CACHE_LINE) * CACHE_LINE);
+    padded = aligned_alloc(CACHE_LINE, num_threads * sizeof(padded_slot));
+    if (!packed || !padded) {
+        perror("aligned_alloc");
+        return 1;
+    }
+    for (int i = 0; i < num_threads; i++) {
+        packed[i].sum = 0;
+        padded[i].sum = 0;
+    }
+
+    double packed_ms = run(num_threads, 0);
+    double padded_ms = run(num_threads, 1);
+
+    printf("threads=%d iterations=%ld\n", num_threads, iterations);
+    printf("packed slots (%zu bytes apart): %10.2f ms\n", sizeof(packed_slot), packed_ms);
+    printf("padded slots (%zu bytes apart): %10.2f ms\n", sizeof(padded_slot), padded_ms);
+    printf("speedup from padding: %.2fx\n", packed_ms / padded_ms);
+
+    free(packed);
+    free(padded);
+    return 0;
+}
@@ -0,0 +1,310 @@
+// perfctr.c
+// Implementation of the counter layer declared in perfctr.h.
+
+#define _GNU_SOURCE       // syscall(), RUSAGE_THREAD
+#include "perfctr.h"
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <linux/perf_event.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+
+typedef struct {
+    const char* name;           // column header in the report
+    unsigned type;
+    unsigned long long config;
+} event_desc;
+
+static const event_desc events[PERFCTR_NEVENTS] = {
+    [PERFCTR_CYCLES]         = { "cycles",      PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+    [PERFCTR_INSTRUCTIONS]   = { "instr",       PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+    [PERFCTR_CACHE_MISSES]   = { "cache-miss",  PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES },
+    [PERFCTR_BRANCH_MISSES]  = { "branch-miss", PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES },
+    [PERFCTR_TASK_CLOCK]     = { "cpu ms",      PERF_TYPE_SOFTWARE, PERF_COUNT_SW_TASK_CLOCK },
+    [PERFCTR_CTX_SWITCHES]   = { "ctx-sw",      PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CONTEXT_SWITCHES },
+    [PERFCTR_CPU_MIGRATIONS] = { "migr",        PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CPU_MIGRATIONS },
+    [PERFCTR_PAGE_FAULTS]    = { "faults",      PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS },
+};
+
+// Group boundaries: [0, FIRST_SW) is the hardware group, the rest is software.
+#define FIRST_SW PERFCTR_TASK_CLOCK
+
+static struct {
+    int enabled;
+    unsigned flags;
+    int exclude_kernel;         // perf_event_paranoid only let us count user space
+    int rusage;                 // some thread fell back to getrusage()
+    int avail[PERFCTR_NEVENTS];
+
+    pthread_mutex_t lock;       // guards region registration
+    pthread_key_t key;          // frees per-thread counters at thread exit
+    int nregions;
+    char* names[PERFCTR_MAX_REGIONS];
+    unsigned long long calls[PERFCTR_MAX_REGIONS];
+    unsigned long long wall_ns[PERFCTR_MAX_REGIONS];
+    unsigned long long totals[PERFCTR_MAX_REGIONS][PERFCTR_NEVENTS];
+} g = { .lock = PTHREAD_MUTEX_INITIALIZER };
+
+typedef struct {
+    int fd[PERFCTR_NEVENTS];    // -1 when not open
+    int leader[2];              // hardware and software group leaders (group mode), -1 if none
+    int use_rusage;
+    unsigned long long start[PERFCTR_MAX_REGIONS][PERFCTR_NEVENTS];
+    long long start_ns[PERFCTR_MAX_REGIONS];
+} thread_ctrs;
+
+static _Thread_local thread_ctrs* tls;
+
+static long long now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+// ---------- Opening counters ----------
+
+static int open_event(int e, int group_fd, int inherit) {
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = events[e].type;
+    attr.config = events[e].config;
+    attr.inherit = (unsigned)inherit;
+    attr.exclude_hv = 1;
+    attr.exclude_kernel = (unsigned)__atomic_load_n(&g.exclude_kernel, __ATOMIC_RELAXED);
+    attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    if (!inherit) attr.read_format |= PERF_FORMAT_GROUP;
+
+    int fd = (int)syscall(SYS_perf_event_open, &attr, 0, -1, group_fd, PERF_FLAG_FD_CLOEXEC);
+    if (fd < 0 && errno == EACCES && !attr.exclude_kernel) {
+        // perf_event_paranoid >= 2: unprivileged users may only count user space.
+        __atomic_store_n(&g.exclude_kernel, 1, __ATOMIC_RELAXED);
+        attr.exclude_kernel = 1;
+        fd = (int)syscall(SYS_perf_event_open, &attr, 0, -1, group_fd, PERF_FLAG_FD_CLOEXEC);
+    }
+    return fd;
+}
+
+static void close_ctrs(thread_ctrs* t) {
+    for (int e = 0; e < PERFCTR_NEVENTS; ++e) {
+        if (t->fd[e] >= 0) close(t->fd[e]);
+    }
+    free(t);
+}
+
+static void thread_exit(void* p) { close_ctrs((thread_ctrs*)p); }
+
+static void after_fork_child(void) {
+    // The child's copies of the fds still count the parent thread.
+    if (tls) {
+        close_ctrs(tls);
+        tls = NULL;
+        pthread_setspecific(g.key, NULL);
+    }
+}
+
+static thread_ctrs* thread_get(void) {
+    if (tls) return tls;
+    thread_ctrs* t = calloc(1, sizeof(*t));
+    if (!t) return NULL;
+    for (int e = 0; e < PERFCTR_NEVENTS; ++e) t->fd[e] = -1;
+    t->leader[0] = t->leader[1] = -1;
+
+    int inherit = (g.flags & PERFCTR_INHERIT) != 0;
+    int opened = 0;
+    static const int bounds[3] = { 0, FIRST_SW, PERFCTR_NEVENTS };
+    for (int grp = 0; grp < 2; ++grp) {
+        for (int e = bounds[grp]; e < bounds[grp + 1]; ++e) {
+            t->fd[e] = open_event(e, inherit ? -1 : t->leader[grp], inherit);
+            if (t->fd[e] < 0) {
+                // Without its leader (first event) the group is skipped;
+                // a missing member only loses that event.
+                if (!inherit && t->leader[grp] < 0) break;
+                continue;
+            }
+            if (!inherit && t->leader[grp] < 0) t->leader[grp] = t->fd[e];
+            __atomic_store_n(&g.avail[e], 1, __ATOMIC_RELAXED);
+            opened++;
+        }
+    }
+
+    // Nothing from perf at all: getrusage() and the CPU clock instead.
+    if (opened == 0) {
+        t->use_rusage = 1;
+        __atomic_store_n(&g.rusage, 1, __ATOMIC_RELAXED);
+        __atomic_store_n(&g.avail[PERFCTR_TASK_CLOCK], 1, __ATOMIC_RELAXED);
+        __atomic_store_n(&g.avail[PERFCTR_CTX_SWITCHES], 1, __ATOMIC_RELAXED);
+        __atomic_store_n(&g.avail[PERFCTR_PAGE_FAULTS], 1, __ATOMIC_RELAXED);
+    }
+
+    tls = t;
+    pthread_setspecific(g.key, t);
+    return t;
+}
+
+// ---------- Reading ----------
+
+// Multiplexed counters only ran part of the time; extrapolate to the whole.
+static unsigned long long scaled(unsigned long long v, unsigned long long enabled, unsigned long long running) {
+    if (running == 0 || running >= enabled) return v;
+    return (unsigned long long)((double)v * ((double)enabled / (double)running));
+}
+
+static void read_group(const thread_ctrs* t, int grp, unsigned long long v[PERFCTR_NEVENTS]) {
+    if (t->leader[grp] < 0) return;
+    unsigned long long buf[3 + PERFCTR_NEVENTS];   // nr, time_enabled, time_running, values
+    if (read(t->leader[grp], buf, sizeof(buf)) < (ssize_t)(3 * sizeof(unsigned long long))) return;
+
+    // Values come back in the order the members were opened.
+    unsigned long long k = 0;
+    int from = grp ? FIRST_SW : 0, to = grp ? PERFCTR_NEVENTS : FIRST_SW;
+    for (int e = from; e < to && k < buf[0]; ++e) {
+        if (t->fd[e] >= 0) v[e] = scaled(buf[3 + k++], buf[1], buf[2]);
+    }
+}
+
+static void read_rusage(unsigned long long v[PERFCTR_NEVENTS]) {
+    struct rusage ru;
+    int inherit = (g.flags & PERFCTR_INHERIT) != 0;
+    if (inherit) {
+        // The whole process plus reaped children, as inherited counters would see it.
+        struct rusage ch;
+        getrusage(RUSAGE_SELF, &ru);
+        getrusage(RUSAGE_CHILDREN, &ch);
+        ru.ru_utime.tv_sec += ch.ru_utime.tv_sec;  ru.ru_utime.tv_usec += ch.ru_utime.tv_usec;
+        ru.ru_stime.tv_sec += ch.ru_stime.tv_sec;  ru.ru_stime.tv_usec += ch.ru_stime.tv_usec;
+        ru.ru_nvcsw += ch.ru_nvcsw;  ru.ru_nivcsw += ch.ru_nivcsw;
+        ru.ru_minflt += ch.ru_minflt;  ru.ru_majflt += ch.ru_majflt;
+        v[PERFCTR_TASK_CLOCK] = (unsigned long long)(ru.ru_utime.tv_sec + ru.ru_stime.tv_sec) * 1000000000ULL +
+                                (unsigned long long)(ru.ru_utime.tv_usec + ru.ru_stime.tv_usec) * 1000ULL;
+    } else {
+        struct timespec ts;
+        getrusage(RUSAGE_THREAD, &ru);
+        clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+        v[PERFCTR_TASK_CLOCK] = (unsigned long long)ts.tv_sec * 1000000000ULL + (unsigned long long)ts.tv_nsec;
+    }
+    v[PERFCTR_CTX_SWITCHES] = (unsigned long long)(ru.ru_nvcsw + ru.ru_nivcsw);
+    v[PERFCTR_PAGE_FAULTS] = (unsigned long long)(ru.ru_minflt + ru.ru_majflt);
+}
+
+static void read_now(const thread_ctrs* t, unsigned long long v[PERFCTR_NEVENTS]) {
+    memset(v, 0, sizeof(unsigned long long) * PERFCTR_NEVENTS);
+    if (t->use_rusage) {
+        read_rusage(v);
+    } else if (g.flags & PERFCTR_INHERIT) {
+        for (int e = 0; e < PERFCTR_NEVENTS; ++e) {
+            unsigned long long buf[3];   // value, time_enabled, time_running
+            if (t->fd[e] >= 0 && read(t->fd[e], buf, sizeof(buf)) == (ssize_t)sizeof(buf)) {
+                v[e] = scaled(buf[0], buf[1], buf[2]);
+            }
+        }
+    } else {
+        read_group(t, 0, v);
+        read_group(t, 1, v);
+    }
+}
+
+// ---------- Public API ----------
+
+int perfctr_init(unsigned flags) {
+    if (g.enabled) { errno = EBUSY; return -1; }
+    g.flags = flags;
+    if (pthread_key_create(&g.key, thread_exit) != 0) return -1;
+    pthread_atfork(NULL, NULL, after_fork_child);
+    __atomic_store_n(&g.enabled, 1, __ATOMIC_RELEASE);
+    return 0;
+}
+
+int perfctr_enabled(void) {
+    return __atomic_load_n(&g.enabled, __ATOMIC_ACQUIRE);
+}
+
+int perfctr_region(const char* name) {
+    if (!perfctr_enabled()) return -1;
+    pthread_mutex_lock(&g.lock);
+    int id = -1;
+    for (int i = 0; i < g.nregions; ++i) {
+        if (strcmp(g.names[i], name) == 0) { id = i; break; }
+    }
+    if (id < 0 && g.nregions < PERFCTR_MAX_REGIONS) {
+        char* copy = strdup(name);
+        if (copy) {
+            id = g.nregions;
+            g.names[id] = copy;
+            __atomic_store_n(&g.nregions, id + 1, __ATOMIC_RELEASE);
+        }
+    }
+    pthread_mutex_unlock(&g.lock);
+    return id;
+}
+
+static int valid_region(int r) {
+    return r >= 0 && r < __atomic_load_n(&g.nregions, __ATOMIC_ACQUIRE);
+}
+
+void perfctr_start(int region) {
+    if (!perfctr_enabled() || !valid_region(region)) return;
+    thread_ctrs* t = thread_get();
+    if (!t) return;
+    read_now(t, t->start[region]);
+    t->start_ns[region] = now_ns();
+}
+
+void perfctr_stop(int region) {
+    if (!perfctr_enabled() || !valid_region(region) || !tls) return;
+    thread_ctrs* t = tls;
+    long long end = now_ns();
+    unsigned long long v[PERFCTR_NEVENTS];
+    read_now(t, v);
+
+    for (int e = 0; e < PERFCTR_NEVENTS; ++e) {
+        if (v[e] > t->start[region][e]) {
+            __atomic_fetch_add(&g.totals[region][e], v[e] - t->start[region][e], __ATOMIC_RELAXED);
+        }
+    }
+    __atomic_fetch_add(&g.wall_ns[region], (unsigned long long)(end - t->start_ns[region]), __ATOMIC_RELAXED);
+    __atomic_fetch_add(&g.calls[region], 1ULL, __ATOMIC_RELAXED);
+}
+
+void perfctr_report(FILE* out) {
+    if (!perfctr_enabled()) return;
+    fflush(stdout);   // the program's own output first
+    int n = __atomic_load_n(&g.nregions, __ATOMIC_ACQUIRE);
+    int ipc = g.avail[PERFCTR_CYCLES] && g.avail[PERFCTR_INSTRUCTIONS];
+    int mpki = g.avail[PERFCTR_CACHE_MISSES] && g.avail[PERFCTR_INSTRUCTIONS];
+
+    fprintf(out, "perf counters (%s%s%s%s):\n",
+            g.rusage ? "getrusage fallback" : "perf_event_open",
+            !g.rusage && !g.avail[PERFCTR_CYCLES] ? ", no hardware PMU" : "",
+            g.exclude_kernel ? ", user space only" : "",
+            g.flags & PERFCTR_INHERIT ? ", children included" : ", per thread");
+    fprintf(out, "%-16s %8s %10s", "region", "calls", "wall ms");
+    for (int e = 0; e < PERFCTR_NEVENTS; ++e) {
+        if (g.avail[e]) fprintf(out, " %12s", events[e].name);
+    }
+    if (ipc) fprintf(out, " %6s", "IPC");
+    if (mpki) fprintf(out, " %9s", "miss/1k");
+    fputc('\n', out);
+
+    for (int r = 0; r < n; ++r) {
+        const unsigned long long* v = g.totals[r];
+        fprintf(out, "%-16s %8llu %10.3f", g.names[r], g.calls[r], (double)g.wall_ns[r] / 1e6);
+        for (int e = 0; e < PERFCTR_NEVENTS; ++e) {
+            if (!g.avail[e]) continue;
+            if (e == PERFCTR_TASK_CLOCK) fprintf(out, " %12.3f", (double)v[e] / 1e6);
+            else fprintf(out, " %12llu", v[e]);
+        }
+        if (ipc) {
+            fprintf(out, " %6.2f", v[PERFCTR_CYCLES] ? (double)v[PERFCTR_INSTRUCTIONS] / (double)v[PERFCTR_CYCLES] : 0.0);
+        }
+        if (mpki) {
+            fprintf(out, " %9.2f", v[PERFCTR_INSTRUCTIONS] ? 1e3 * (double)v[PERFCTR_CACHE_MISSES] / (double)v[PERFCTR_INSTRUCTIONS] : 0.0);
+        }
+        fputc('\n', out);
+    }
+}
@@ -0,0 +1,67 @@
+// perfctr.h
+// Small perf_event_open() instrumentation layer shared by the lab programs.
+//
+//     perfctr_init(0);                         // once, e.g. when the program's -P flag is set
+//     static int r = -1;
+//     if (r < 0) r = perfctr_region("sum");    // or register every region up front
+//     perfctr_start(r);
+//     ... hot code ...
+//     perfctr_stop(r);
+//     perfctr_report(stderr);                  // one table, all threads added up
+//
+// Every thread lazily opens its own counters the first time it starts a region:
+// a hardware group (cycles, instructions, cache misses, branch misses) and a
+// software group (task clock, context switches, CPU migrations, page faults),
+// each read with a single read(). When the PMU is missing, as in most VMs, the
+// hardware group is skipped. When perf_event_open() is not allowed at all,
+// getrusage() and the thread CPU clock stand in for the software counters.
+// The report says which source was used.
+//
+// With PERFCTR_INHERIT the counters are opened one by one with inherit set, so
+// threads and processes created inside a region are counted once they have
+// exited and been reaped (a forked child, a shell command, threads created per
+// call). Without it only the calling thread is counted.
+//
+// Until perfctr_init() succeeds every call is a cheap no-op, so call sites need
+// no flag checks of their own. Regions may nest and may be used from any
+// number of threads; they must not be started twice in the same thread.
+
+#ifndef PERFCTR_H
+#define PERFCTR_H
+
+#include <stdio.h>
+
+#define PERFCTR_MAX_REGIONS 32
+
+enum {
+    PERFCTR_INHERIT = 1 << 0,   // count children created inside a region (see above)
+};
+
+typedef enum {
+    PERFCTR_CYCLES,
+    PERFCTR_INSTRUCTIONS,
+    PERFCTR_CACHE_MISSES,
+    PERFCTR_BRANCH_MISSES,
+    PERFCTR_TASK_CLOCK,         // ns of CPU time
+    PERFCTR_CTX_SWITCHES,
+    PERFCTR_CPU_MIGRATIONS,
+    PERFCTR_PAGE_FAULTS,
+    PERFCTR_NEVENTS
+} perfctr_event;
+
+// Returns 0. Fails (-1, errno set) only if called twice.
+int perfctr_init(unsigned flags);
+int perfctr_enabled(void);
+
+// Returns the id for `name`, registering it on first use; -1 once
+// PERFCTR_MAX_REGIONS are taken or when not enabled.
+int perfctr_region(const char* name);
+
+void perfctr_start(int region);
+void perfctr_stop(int region);
+
+// One line per region with calls, wall time, every available event, IPC and
+// misses per 1000 instructions. Does nothing when not enabled.
+void perfctr_report(FILE* out);
+
+#endif // PERFCTR_H